@@ -213,7 +213,7 @@ function(catch_discover_tests TARGET_LIST TEST_SET)
   cmake_parse_arguments(
     ""
     ""
-    "TEST_PREFIX;TEST_SUFFIX;WORKING_DIRECTORY;TEST_LIST;REPORTER;OUTPUT_DIR;OUTPUT_PREFIX;OUTPUT_SUFFIX"
+    "TEST_PREFIX;TEST_SUFFIX;WORKING_DIRECTORY;TEST_LIST;REPORTER;OUTPUT_DIR;OUTPUT_PREFIX;OUTPUT_SUFFIX;BATCH_SIZE;TIMINGS"
     "TEST_SPEC;EXTRA_ARGS;PROPERTIES"
     ${ARGN}
   )
@@ -236,7 +236,14 @@ function(catch_discover_tests TARGET_LIST TEST_SET)
       file(APPEND ${ctest_include_file} "set(_CATCH_ADD_TEST_SCRIPT ${_CATCH_ADD_TEST_SCRIPT})\n")
       file(APPEND ${ctest_include_file} "set(crosscompiling_emulator ${crosscompiling_emulator})\n")
       file(APPEND ${ctest_include_file} "set(_PROPERTIES ${_PROPERTIES})\n")
+      file(APPEND ${ctest_include_file} "set(_BATCH_SIZE ${_BATCH_SIZE})\n")
+      file(APPEND ${ctest_include_file} "set(_TIMINGS \"${_TIMINGS}\")\n")
       file(APPEND ${ctest_include_file} "include(${CATCH_INCLUDE_PATH})\n")
+      # Register the test set, ctest lists all test sets of the build to shard them
+      if(CATCH_TEST_SETS_PATH)
+        file(APPEND ${CATCH_TEST_SETS_PATH} "catch_test_set([==[${CMAKE_CURRENT_BINARY_DIR}]==] "
+             "[==[${ctestfilepath}]==] [==[${crosscompiling_emulator}]==] ${TARGET_LIST})\n")
+      endif()
       # Add discovered tests to directory TEST_INCLUDE_FILES      
       set_property(DIRECTORY
         APPEND PROPERTY TEST_INCLUDE_FILES "${ctestincludepath}"
@@ -337,9 +344,13 @@ endfunction()
 ###############################################################################
 # current staging
 # function to be called by all tests
+# BATCH_SIZE N registers a ctest entry per N test cases which runs them in one process with
+# --batch instead of an entry per test case, CATCH_BATCH_SIZE sets the default for all targets.
+# TIMINGS names the file the test cases record their durations to, the ctest COST of every test
+# is taken from it. CATCH_TEST_TIMINGS sets the default for all targets.
 function(hip_add_exe_to_target)
   set(options)
-  set(args NAME TEST_TARGET_NAME PLATFORM COMPILE_OPTIONS)
+  set(args NAME TEST_TARGET_NAME PLATFORM COMPILE_OPTIONS BATCH_SIZE TIMINGS)
   set(list_args TEST_SRC LINKER_LIBS COMMON_SHARED_SRC PROPERTY)
   cmake_parse_arguments(
     PARSE_ARGV 0
@@ -411,6 +422,20 @@ function(hip_add_exe_to_target)
 
   endforeach()
 
-  catch_discover_tests("${_EXE_NAME_LIST}" "${_NAME}" PROPERTIES  SKIP_REGULAR_EXPRESSION "HIP_SKIP_THIS_TEST")
+  if(NOT DEFINED _BATCH_SIZE)
+    set(_BATCH_SIZE ${CATCH_BATCH_SIZE})
+  endif()
+  if(NOT DEFINED _TIMINGS)
+    set(_TIMINGS ${CATCH_TEST_TIMINGS})
+  endif()
+  if(_BATCH_SIZE GREATER 0)
+    # Skipped test cases are reported in the JUnit file of the batch, a skip regex would skip
+    # the whole batch
+    catch_discover_tests("${_EXE_NAME_LIST}" "${_NAME}" BATCH_SIZE ${_BATCH_SIZE}
+                         TIMINGS "${_TIMINGS}")
+  else()
+    catch_discover_tests("${_EXE_NAME_LIST}" "${_NAME}" TIMINGS "${_TIMINGS}"
+                         PROPERTIES  SKIP_REGULAR_EXPRESSION "HIP_SKIP_THIS_TEST")
+  endif()
 endfunction()
 
@@ -5,11 +5,15 @@ set(prefix "${TEST_PREFIX}")
 set(suffix "${TEST_SUFFIX}")
 set(spec ${TEST_SPEC})
 set(extra_args ${TEST_EXTRA_ARGS})
+set(shard_dir ${TEST_SHARD_DIR})
 set(properties ${TEST_PROPERTIES})
 set(reporter ${TEST_REPORTER})
 set(output_dir ${TEST_OUTPUT_DIR})
 set(output_prefix ${TEST_OUTPUT_PREFIX})
 set(output_suffix ${TEST_OUTPUT_SUFFIX})
+set(batch_size ${TEST_BATCH_SIZE})
+set(timings_file ${TEST_TIMINGS})
+set(discover_file ${TEST_DISCOVER_FILE})
 set(script)
 set(suite)
 set(tests)
@@ -29,6 +33,98 @@ function(add_command NAME)
   set(script "${script}${NAME}(${_args})\n" PARENT_SCOPE)
 endfunction()
 
+include("${CMAKE_CURRENT_LIST_DIR}/CatchTimings.cmake")
+
+# Sets OUT to the COST property of a test expected to take MILLISECONDS, in seconds
+function(get_cost OUT MILLISECONDS)
+  math(EXPR seconds "${MILLISECONDS} / 1000")
+  math(EXPR fraction "${MILLISECONDS} % 1000 + 1000")
+  string(SUBSTRING "${fraction}" 1 3 fraction)
+  set(${OUT} "${seconds}.${fraction}" PARENT_SCOPE)
+endfunction()
+
+# Registers a single test running the test cases collected in batch_tests with --batch
+macro(add_batch)
+  set(batch_name "${prefix}${exe_name}_batch_${batch_index}${suffix}")
+  set(batch_file "${batch_dir}/${exe_name}_batch_${batch_index}.txt")
+  file(WRITE "${batch_file}" "${batch_tests}")
+  if(output_dir)
+    set(junit_file "${output_dir}/${output_prefix}${exe_name}_batch_${batch_index}${output_suffix}.xml")
+  else()
+    set(junit_file "${batch_dir}/${exe_name}_batch_${batch_index}.xml")
+  endif()
+  add_command(add_test
+    "${batch_name}"
+    ${TEST_EXECUTOR}
+    "${exe_path}"
+    --batch "${batch_file}"
+    --batch-junit "${junit_file}"
+    ${extra_args}
+  )
+  set(batch_properties ${properties})
+  if(batch_cost GREATER 0)
+    get_cost(cost ${batch_cost})
+    list(APPEND batch_properties COST ${cost})
+  endif()
+  if(batch_properties)
+    add_command(set_tests_properties
+      "${batch_name}"
+      PROPERTIES
+      ${batch_properties}
+    )
+  endif()
+  list(APPEND tests "${batch_name}")
+  math(EXPR batch_index "${batch_index} + 1")
+  set(batch_tests "")
+  set(batch_count 0)
+  set(batch_cost 0)
+endmacro()
+
+read_timings("${timings_file}")
+
+# Lists the test cases of EXE, and its reporters if a reporter is requested, in one run.
+# The listing is cached next to CTEST_FILE, keyed by the size and modification time of the
+# executable and by the listing arguments, so that unchanged executables are not run again.
+# Sets output and result like execute_process.
+function(list_test_executable EXE)
+  set(list_args ${spec} --list-test-names-only)
+  if(reporter)
+    list(APPEND list_args --list-reporters)
+  endif()
+
+  file(SIZE "${EXE}" exe_size)
+  file(TIMESTAMP "${EXE}" exe_time "%s" UTC)
+  set(key "${EXE};${exe_size};${exe_time};${TEST_EXECUTOR};${list_args}")
+  string(SHA1 key "${key}")
+
+  get_filename_component(cache_name "${EXE}" NAME_WE)
+  get_filename_component(cache_dir "${CTEST_FILE}" ABSOLUTE)
+  get_filename_component(cache_dir "${cache_dir}" DIRECTORY)
+  set(cache_file "${cache_dir}/${cache_name}_discovery")
+  if(EXISTS "${cache_file}.cmake" AND EXISTS "${cache_file}.txt")
+    include("${cache_file}.cmake")
+    if(cached_key STREQUAL key)
+      file(READ "${cache_file}.txt" cached_output)
+      set(output "${cached_output}" PARENT_SCOPE)
+      set(result ${cached_result} PARENT_SCOPE)
+      return()
+    endif()
+  endif()
+
+  execute_process(
+    COMMAND ${TEST_EXECUTOR} "${EXE}" ${list_args}
+    OUTPUT_VARIABLE output
+    RESULT_VARIABLE result
+    WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  )
+  # Failed runs are not cached, they may be caused by the environment
+  if(result GREATER -1)
+    file(WRITE "${cache_file}.txt" "${output}")
+    file(WRITE "${cache_file}.cmake" "set(cached_key ${key})\nset(cached_result ${result})\n")
+  endif()
+  set(output "${output}" PARENT_SCOPE)
+  set(result ${result} PARENT_SCOPE)
+endfunction()
 
 foreach(TEST_EXECUTABLE ${TEST_EXE_LIST})
   if(WIN32)
@@ -41,18 +137,8 @@ foreach(TEST_EXECUTABLE ${TEST_EXE_LIST})
     # exe does not exist moving to the next executable
     continue()
   endif()
-  execute_process(
-    COMMAND ${TEST_EXECUTOR} "${TEST_EXECUTABLE}" ${spec} --list-test-names-only
-    OUTPUT_VARIABLE output
-    RESULT_VARIABLE result
-    WORKING_DIRECTORY "${TEST_WORKING_DIR}"
-  )
-  # Catch --list-test-names-only reports the number of tests, so 0 is... surprising
-  if(${result} EQUAL 0)
-    message(WARNING
-      "Test executable '${TEST_EXECUTABLE}' contains no tests!\n"
-    )
-  elseif(${result} LESS 0)
+  list_test_executable("${TEST_EXECUTABLE}")
+  if(${result} LESS 0)
     message(FATAL_ERROR
       "Error running test executable '${TEST_EXECUTABLE}':\n"
       "  Result: ${result}\n"
@@ -60,26 +146,51 @@ foreach(TEST_EXECUTABLE ${TEST_EXE_LIST})
     )
   endif()
 
+  # The reporters are listed after the test case names
+  set(reporters_output "")
+  string(FIND "${output}" "Available reporters:" reporters_begin)
+  if(reporters_begin GREATER -1)
+    string(SUBSTRING "${output}" ${reporters_begin} -1 reporters_output)
+    string(SUBSTRING "${output}" 0 ${reporters_begin} output)
+  endif()
   string(REPLACE "\n" ";" output "${output}")
+  if(reporter AND reporters_output STREQUAL "")
+    message(FATAL_ERROR
+      "Error listing the reporters of test executable '${TEST_EXECUTABLE}':\n"
+      "  Result: ${result}\n"
+    )
+  endif()
 
-  # Run test executable to get list of available reporters
-  execute_process(
-    COMMAND ${TEST_EXECUTOR} "${TEST_EXECUTABLE}" ${spec} --list-reporters
-    OUTPUT_VARIABLE reporters_output
-    RESULT_VARIABLE reporters_result
-    WORKING_DIRECTORY "${TEST_WORKING_DIR}"
-  )
-  if(${reporters_result} EQUAL 0)
+  # The exit code of Catch counts the listed reporters too, so the test cases are counted here
+  set(test_count 0)
+  foreach(line ${output})
+    math(EXPR test_count "${test_count} + 1")
+  endforeach()
+  if(test_count EQUAL 0 AND NOT discover_file)
     message(WARNING
-      "Test executable '${TEST_EXECUTABLE}' contains no reporters!\n"
-    )
-  elseif(${reporters_result} LESS 0)
-    message(FATAL_ERROR
-      "Error running test executable '${TEST_EXECUTABLE}':\n"
-      "  Result: ${reporters_result}\n"
-      "  Output: ${reporters_output}\n"
+      "Test executable '${TEST_EXECUTABLE}' contains no tests!\n"
     )
   endif()
+
+  # With TEST_DISCOVER_FILE the test cases are only listed, for CatchShardTests.cmake
+  if(discover_file)
+    set(discovered "")
+    foreach(line ${output})
+      string(APPEND discovered "${TEST_EXECUTABLE}\t${line}\n")
+    endforeach()
+    file(APPEND "${discover_file}" "${discovered}")
+    continue()
+  endif()
+
+  # Only the test cases of the shard of this machine are registered, see CatchShardTests.cmake
+  if(shard_dir)
+    string(SHA1 shard_file "${TEST_EXECUTABLE}")
+    set(output "")
+    if(EXISTS "${shard_dir}/${shard_file}.txt")
+      file(STRINGS "${shard_dir}/${shard_file}.txt" output)
+    endif()
+  endif()
+
   string(FIND "${reporters_output}" "${reporter}" reporter_is_valid)
   if(reporter AND ${reporter_is_valid} EQUAL -1)
     message(FATAL_ERROR
@@ -100,6 +211,33 @@ foreach(TEST_EXECUTABLE ${TEST_EXE_LIST})
     endif()
   endif()
 
+  # Group the test cases into batches, each run by a single test
+  if(batch_size GREATER 0)
+    get_filename_component(exe_name ${TEST_EXECUTABLE} NAME_WE)
+    get_filename_component(batch_dir ${CTEST_FILE} ABSOLUTE)
+    get_filename_component(batch_dir ${batch_dir} DIRECTORY)
+    file(RELATIVE_PATH exe_path ${CMAKE_CURRENT_BINARY_DIR} ${TEST_EXECUTABLE})
+    set(batch_tests "")
+    set(batch_count 0)
+    set(batch_index 0)
+    set(batch_cost 0)
+    foreach(line ${output})
+      string(APPEND batch_tests "${line}\n")
+      math(EXPR batch_count "${batch_count} + 1")
+      if(DEFINED "timing_ms_${line}")
+        math(EXPR batch_cost "${batch_cost} + ${timing_ms_${line}}")
+      endif()
+      if(batch_count EQUAL batch_size)
+        add_batch()
+      endif()
+    endforeach()
+    if(batch_count GREATER 0)
+      add_batch()
+    endif()
+    add_command(set ${TEST_LIST} ${tests})
+    continue()
+  endif()
+
   # Parse output
   foreach(line ${output})
     set(test ${line})
@@ -126,10 +264,15 @@ foreach(TEST_EXECUTABLE ${TEST_EXE_LIST})
       "${reporter_arg}"
       "${output_dir_arg}"
     )
+    set(test_properties ${properties})
+    if(DEFINED "timing_ms_${test}")
+      get_cost(cost ${timing_ms_${test}})
+      list(APPEND test_properties COST ${cost})
+    endif()
     add_command(set_tests_properties
       "${prefix}${test}${suffix}"
       PROPERTIES
-      ${properties}
+      ${test_properties}
     )
     list(APPEND tests "${prefix}${test}${suffix}")
   endforeach()
@@ -141,4 +284,7 @@ foreach(TEST_EXECUTABLE ${TEST_EXE_LIST})
 endforeach()
 
 # Write CTest script
+if(discover_file)
+  return()
+endif()
 file(WRITE "${CTEST_FILE}" "${script}")
@@ -0,0 +1,151 @@
+# Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+# file Copyright.txt or https://cmake.org/licensing for details.
+
+# Partitions the test cases of every test set of the build into SHARD_COUNT shards of similar
+# total duration and writes the test cases of shard SHARD_INDEX to SHARD_DIR, one file per
+# executable named by the SHA1 of its path. Run by catch_include.cmake once per ctest run, before
+# any test set registers its tests.
+#   TEST_SETS       : test sets of the build, written by catch_discover_tests at configure time
+#   ADD_TEST_SCRIPT : CatchAddTests.cmake, lists the test cases of a test set
+#   SHARD_TIMINGS   : timings file the durations are taken from. Every machine has to read the
+#                     same content to compute the same partition.
+#
+# Test cases are assigned longest first to the shard with the least total duration so far, test
+# cases without a recorded duration count as the median duration. Ties are broken by the path of
+# the executable relative to the build directory and by the test case name. The partition is
+# kept until the test cases, the content of SHARD_TIMINGS or the shard change.
+
+include("${CMAKE_CURRENT_LIST_DIR}/CatchTimings.cmake")
+get_filename_component(build_root "${CMAKE_CURRENT_LIST_DIR}/../.." ABSOLUTE)
+
+get_filename_component(SHARD_DIR "${SHARD_DIR}" ABSOLUTE)
+file(MAKE_DIRECTORY "${SHARD_DIR}")
+set(discovered_file "${SHARD_DIR}/discovered.txt")
+file(WRITE "${discovered_file}" "")
+
+# Lists the test cases of the executables of a test set into discovered_file
+function(catch_test_set BINARY_DIR CTEST_FILE EXECUTOR)
+  execute_process(
+    COMMAND "${CMAKE_COMMAND}"
+            -D "TEST_EXE_LIST=${ARGN}"
+            -D "TEST_EXECUTOR=${EXECUTOR}"
+            -D "CTEST_FILE=${CTEST_FILE}"
+            -D "TEST_DISCOVER_FILE=${discovered_file}"
+            -P "${ADD_TEST_SCRIPT}"
+    RESULT_VARIABLE result
+    WORKING_DIRECTORY "${BINARY_DIR}"
+  )
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Unable to list the test cases of ${BINARY_DIR}/${CTEST_FILE}")
+  endif()
+endfunction()
+
+if(EXISTS "${TEST_SETS}")
+  include("${TEST_SETS}")
+endif()
+
+file(SHA1 "${discovered_file}" partition_key)
+string(APPEND partition_key ";${SHARD_INDEX};${SHARD_COUNT}")
+if(SHARD_TIMINGS AND EXISTS "${SHARD_TIMINGS}")
+  file(SHA1 "${SHARD_TIMINGS}" timings_hash)
+  string(APPEND partition_key ";${timings_hash}")
+endif()
+set(key_file "${SHARD_DIR}/key.txt")
+if(EXISTS "${key_file}")
+  file(READ "${key_file}" cached_key)
+  if(cached_key STREQUAL partition_key)
+    return()
+  endif()
+endif()
+file(GLOB previous "${SHARD_DIR}/*.txt")
+list(REMOVE_ITEM previous "${discovered_file}")
+if(previous)
+  file(REMOVE ${previous})
+endif()
+
+read_timings("${SHARD_TIMINGS}")
+file(STRINGS "${discovered_file}" entries)
+list(REMOVE_DUPLICATES entries)  # A test set may be registered more than once
+
+# Sorts the lexicographic keys of numbers by zero padding them to 15 digits
+function(get_sort_key OUT NUMBER)
+  string(LENGTH "${NUMBER}" digits)
+  math(EXPR padding "15 - ${digits}")
+  string(REPEAT "0" ${padding} zeros)
+  set(${OUT} "${zeros}${NUMBER}" PARENT_SCOPE)
+endfunction()
+
+set(known "")
+foreach(entry ${entries})
+  string(REGEX REPLACE "^[^\t]*\t" "" test "${entry}")
+  if(DEFINED "timing_ms_${test}")
+    get_sort_key(key ${timing_ms_${test}})
+    list(APPEND known ${key})
+  endif()
+endforeach()
+set(fallback 1000)
+list(LENGTH known known_count)
+if(known_count GREATER 0)
+  list(SORT known)
+  math(EXPR median "${known_count} / 2")
+  list(GET known ${median} fallback)
+  string(REGEX REPLACE "^0+([0-9])" "\\1" fallback "${fallback}")
+endif()
+
+set(keys "")
+foreach(entry ${entries})
+  string(REGEX MATCH "^([^\t]*)\t(.*)$" entry "${entry}")
+  file(RELATIVE_PATH executable "${build_root}" "${CMAKE_MATCH_1}")
+  set(test "${CMAKE_MATCH_2}")
+  set(duration ${fallback})
+  if(DEFINED "timing_ms_${test}")
+    set(duration ${timing_ms_${test}})
+  endif()
+  get_sort_key(key ${duration})
+  list(APPEND keys "${key}\t${executable}\t${test}")
+endforeach()
+list(SORT keys ORDER DESCENDING)
+
+set(loads "")
+foreach(shard RANGE 1 ${SHARD_COUNT})
+  list(APPEND loads 0)
+endforeach()
+foreach(key ${keys})
+  string(REGEX MATCH "^0*([0-9]+)\t([^\t]*)\t(.*)$" key "${key}")
+  set(duration ${CMAKE_MATCH_1})
+  set(assigned "shard_of_${CMAKE_MATCH_2}\t${CMAKE_MATCH_3}")
+  set(shard 0)
+  set(best -1)
+  foreach(load ${loads})
+    if(best EQUAL -1 OR load LESS best_load)
+      set(best ${shard})
+      set(best_load ${load})
+    endif()
+    math(EXPR shard "${shard} + 1")
+  endforeach()
+  math(EXPR best_load "${best_load} + ${duration}")
+  list(REMOVE_AT loads ${best})
+  list(INSERT loads ${best} ${best_load})
+  set("${assigned}" ${best})
+endforeach()
+
+# The test cases of the shard, in the order they were listed
+set(executables "")
+foreach(entry ${entries})
+  string(REGEX MATCH "^([^\t]*)\t(.*)$" entry "${entry}")
+  set(path "${CMAKE_MATCH_1}")
+  set(test "${CMAKE_MATCH_2}")
+  file(RELATIVE_PATH executable "${build_root}" "${path}")
+  set(assigned "shard_of_${executable}\t${test}")
+  if("${${assigned}}" EQUAL SHARD_INDEX)
+    string(SHA1 name "${path}")
+    if(NOT DEFINED "shard_tests_${name}")
+      list(APPEND executables ${name})
+    endif()
+    string(APPEND "shard_tests_${name}" "${test}\n")
+  endif()
+endforeach()
+foreach(name ${executables})
+  file(WRITE "${SHARD_DIR}/${name}.txt" "${shard_tests_${name}}")
+endforeach()
+file(WRITE "${key_file}" "${partition_key}")
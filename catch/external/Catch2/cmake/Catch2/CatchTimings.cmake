@@ -0,0 +1,51 @@
+# Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+# file Copyright.txt or https://cmake.org/licensing for details.
+
+# Reads the durations recorded by previous runs into timing_ms_<test case>, in milliseconds.
+# Every line of the timings file is "name<TAB>seconds<TAB>setup seconds<TAB>result" and the
+# latest line of a test case wins.
+function(read_timings FILE)
+  if(NOT FILE OR NOT EXISTS "${FILE}")
+    return()
+  endif()
+  file(STRINGS "${FILE}" timing_lines)
+  foreach(timing_line ${timing_lines})
+    if(timing_line MATCHES "^([^\t#][^\t]*)\t([0-9]+)(\\.([0-9]*))?")
+      set(fraction "${CMAKE_MATCH_4}000")
+      string(SUBSTRING "${fraction}" 0 3 fraction)
+      math(EXPR milliseconds "${CMAKE_MATCH_2} * 1000 + ${fraction}")
+      set("timing_ms_${CMAKE_MATCH_1}" ${milliseconds} PARENT_SCOPE)
+    endif()
+  endforeach()
+endfunction()
+
+# Rewrites the timings file with only the latest line of every test case, so that reading it does
+# not get slower with every run. Lines appended while it is rewritten are lost, so it is only
+# called before the test cases of this machine run.
+function(compact_timings FILE)
+  if(NOT FILE OR NOT EXISTS "${FILE}")
+    return()
+  endif()
+  file(STRINGS "${FILE}" timing_lines)
+  set(names "")
+  foreach(timing_line ${timing_lines})
+    if(timing_line MATCHES "^([^\t#][^\t]*)\t")
+      if(NOT DEFINED "latest_${CMAKE_MATCH_1}")
+        list(APPEND names "${CMAKE_MATCH_1}")
+      endif()
+      set("latest_${CMAKE_MATCH_1}" "${timing_line}")
+    endif()
+  endforeach()
+  list(LENGTH timing_lines line_count)
+  list(LENGTH names name_count)
+  if(line_count EQUAL name_count)
+    return()
+  endif()
+
+  set(content "")
+  foreach(name ${names})
+    string(APPEND content "${latest_${name}}\n")
+  endforeach()
+  file(WRITE "${FILE}.compact" "${content}")
+  file(RENAME "${FILE}.compact" "${FILE}")
+endfunction()
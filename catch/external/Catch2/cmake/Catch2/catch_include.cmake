@@ -1,7 +1,48 @@
 # when ctest is ran, each submodule includes this file to generate the <submodule>_tests.cmake file.
 # <submodule>_tests.cmake contains the add_test macro which runs the individual test.
 
+# Sharding across machines is configured when ctest runs:
+#   HIP_SHARD_INDEX, HIP_SHARD_COUNT : only register the test cases of this shard. The test cases
+#                      of all test executables are partitioned at once by CatchShardTests.cmake,
+#                      when the first test set is included.
+#   HIP_SHARD_TIMINGS : timings file the shards are balanced with. It is only read, every machine
+#                      has to use the same snapshot to compute the same partition.
+#   HIP_TEST_TIMINGS : timings file the test cases append their durations to, used to set the
+#                      ctest COST of every test. Overrides the TIMINGS file the target was
+#                      configured with
+if(DEFINED ENV{HIP_TEST_TIMINGS})
+  set(_TIMINGS $ENV{HIP_TEST_TIMINGS})
+endif()
+if(_TIMINGS)
+  list(APPEND _EXTRA_ARGS --timings-out ${_TIMINGS})
+  # Keep the latest line of every test case, before any test set reads the file
+  if(NOT DEFINED "_CATCH_COMPACTED_${_TIMINGS}")
+    set("_CATCH_COMPACTED_${_TIMINGS}" ON)
+    include("${CMAKE_CURRENT_LIST_DIR}/CatchTimings.cmake")
+    compact_timings("${_TIMINGS}")
+  endif()
+endif()
+
 get_filename_component(_cmake_path cmake ABSOLUTE)
+set(_SHARD_DIR "")
+if(DEFINED ENV{HIP_SHARD_COUNT})
+  set(_SHARD_DIR "${CMAKE_CURRENT_LIST_DIR}/shard")
+  # ctest includes the test sets of all directories in one scope, so this runs once per ctest run
+  if(NOT _CATCH_SHARDED)
+    set(_CATCH_SHARDED ON)
+    execute_process(
+      COMMAND "${_cmake_path}"
+              -D "TEST_SETS=${CMAKE_CURRENT_LIST_DIR}/test_sets.cmake"
+              -D "ADD_TEST_SCRIPT=${CMAKE_CURRENT_LIST_DIR}/CatchAddTests.cmake"
+              -D "SHARD_INDEX=$ENV{HIP_SHARD_INDEX}"
+              -D "SHARD_COUNT=$ENV{HIP_SHARD_COUNT}"
+              -D "SHARD_TIMINGS=$ENV{HIP_SHARD_TIMINGS}"
+              -D "SHARD_DIR=${_SHARD_DIR}"
+              -P "${CMAKE_CURRENT_LIST_DIR}/CatchShardTests.cmake"
+    )
+  endif()
+endif()
+
 execute_process(
 COMMAND "${_cmake_path}"
         -D "TEST_TARGET=${TARGET}"
@@ -10,6 +51,7 @@ COMMAND "${_cmake_path}"
         -D "TEST_WORKING_DIR=${_workdir}"
         -D "TEST_SPEC=${_TEST_SPEC}"
         -D "TEST_EXTRA_ARGS=${_EXTRA_ARGS}"
+        -D "TEST_SHARD_DIR=${_SHARD_DIR}"
         -D "TEST_PROPERTIES=${_PROPERTIES}"
         -D "TEST_PREFIX=${_TEST_PREFIX}"
         -D "TEST_SUFFIX=${_TEST_SUFFIX}"
@@ -18,6 +60,8 @@ COMMAND "${_cmake_path}"
         -D "TEST_OUTPUT_DIR=${_OUTPUT_DIR}"
         -D "TEST_OUTPUT_PREFIX=${_OUTPUT_PREFIX}"
         -D "TEST_OUTPUT_SUFFIX=${_OUTPUT_SUFFIX}"
+        -D "TEST_BATCH_SIZE=${_BATCH_SIZE}"
+        -D "TEST_TIMINGS=${_TIMINGS}"
         -D "CTEST_FILE=${ctestfilepath}"
         -P "${_CATCH_ADD_TEST_SCRIPT}"
 OUTPUT_VARIABLE output
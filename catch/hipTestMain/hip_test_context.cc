@@ -3,10 +3,12 @@
 #include <picojson.h>
 #include <fstream>
 #include <sstream>
-#include <regex>
 #include "hip_test_context.hh"
 #include "hip_test_filesystem.hh"
 #include "hip_test_features.hh"
+#if defined(HT_EMBEDDED_CONFIG)
+#include "hip_test_embedded_config.hh"
+#endif
 
 void TestContext::detectOS() {
 #if (HT_WIN == 1)
@@ -109,8 +111,14 @@ void TestContext::getConfigFiles() {
       config_.json_files.push_back(env_config);
     }
   } else {
+#if defined(HT_EMBEDDED_CONFIG)
+    // The common config of this platform and OS is resolved and embedded at build time
+    LogPrintf("Embedded config file: %s", kEmbeddedConfigFile);
+    for (auto test = kEmbeddedDisabledTests; *test != nullptr; ++test) skip_test.Add(*test);
+#else
     // get common json file
     config_.json_files.push_back(getCommonJsonFile());
+#endif
   }
 
   for (const auto& fl : config_.json_files) {
@@ -130,6 +138,7 @@ TestContext::TestContext(int argc, char** argv) {
 void TestContext::setExePath(int argc, char** argv) {
   if (argc == 0) return;
   fs::path p = std::string(argv[0]);
+  exe_file = fs::absolute(p).string();
   if (p.has_filename()) p.remove_filename();
   exe_path = p.string();
 }
@@ -146,20 +155,42 @@ void TestContext::parseOptions(int argc, char** argv) {
   current_test = std::string(argv[1]);
 }
 
-bool TestContext::skipTest() const {
-  // Direct Match
-  auto flags = std::regex::ECMAScript;
-  for (const auto& i : skip_test) {
-    auto regex = std::regex(i.c_str(), flags);
-    if (std::regex_match(current_test, regex)) {
-      return true;
+bool TestContext::skipTest() const { return skipTest(current_test); }
+
+bool TestContext::skipTest(const std::string& test_name) const {
+  return skip_test.Matches(test_name);
+}
+
+std::string TestContext::currentPath() const { return fs::current_path().string(); }
+
+void TestContext::loadBuildInfo() {
+  build_info_loaded_ = true;
+  fs::path info_dir = exe_path;
+  info_dir = info_dir.parent_path();
+  // catchInfo.txt lives in the catch_tests folder, check a max of 5 levels down the executable path
+  for (int levels = 0; levels < 5; levels++) {
+    fs::path info_file = info_dir / "catchInfo.txt";
+    if (fs::exists(info_file)) {
+      std::ifstream info(info_file.string());
+      std::string line;
+      while (std::getline(info, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        auto pos = line.find('=');
+        if (pos == std::string::npos) continue;
+        build_info_[line.substr(0, pos)] = line.substr(pos + 1);
+      }
+      LogPrintf("Build info file: %s", info_file.string().c_str());
+      return;
     }
+    info_dir = info_dir.parent_path();
   }
-  // TODO add test case skip as well
-  return false;
 }
 
-std::string TestContext::currentPath() const { return fs::current_path().string(); }
+std::string TestContext::getBuildInfo(const std::string& key) {
+  if (!build_info_loaded_) loadBuildInfo();
+  auto it = build_info_.find(key);
+  return it != build_info_.end() ? it->second : std::string("");
+}
 
 bool TestContext::parseJsonFiles() {
   // Check if file exists
@@ -194,15 +225,7 @@ bool TestContext::parseJsonFiles() {
 
         auto& val = i->second.get<picojson::array>();
         for (auto ai = val.begin(); ai != val.end(); ai++) {
-          std::string tmp = ai->get<std::string>();
-          std::string newRegexName;
-          for (const auto& c : tmp) {
-            if (c == '*')
-              newRegexName += ".*";
-            else
-              newRegexName += c;
-          }
-          skip_test.insert(newRegexName);
+          skip_test.Add(ai->get<std::string>());
         }
       }
     }
@@ -217,6 +240,8 @@ void TestContext::cleanContext() {
       throw std::runtime_error("Unable to unload rtc module");
     }
   }
+  compiledKernels.clear();
+  rtcGeneration_.fetch_add(1, std::memory_order_release);
 }
 
 void TestContext::trackRtcState(std::string kernelNameExpression, hipModule_t loadedModule,
@@ -235,38 +260,71 @@ hipFunction_t TestContext::getFunction(const std::string kernelNameExpression) {
   }
 }
 
-void TestContext::addResults(HCResult r) {
-  std::unique_lock<std::mutex> lock(resultMutex);
-  results.push_back(r);
-  if ((!r.conditionsResult) ||
-      ((r.result != hipSuccess) && (r.result != hipErrorPeerAccessAlreadyEnabled))) {
-    hasErrorOccured_.store(true);
+std::vector<HCResult>& TestContext::getThreadResults() {
+  // The buffer of this thread is owned by the context, so that its results outlive the thread
+  thread_local std::vector<HCResult>* buffer = nullptr;
+  thread_local uint64_t generation = 0;
+  const uint64_t current = resultsGeneration_.load();
+  if (buffer == nullptr || generation != current) {
+    std::unique_lock<std::mutex> lock(resultMutex);
+    threadResults_.push_back(std::make_unique<std::vector<HCResult>>());
+    buffer = threadResults_.back().get();
+    generation = current;
   }
+  return *buffer;
+}
+
+void TestContext::addFailedResult(const HCResult& r) {
+  getThreadResults().push_back(r);
+  hasErrorOccured_.store(true);
 }
 
 void TestContext::finalizeResults() {
-  std::unique_lock<std::mutex> lock(resultMutex);
-  // clear the results whatever happens
-  std::shared_ptr<void> emptyVec(nullptr, [this](auto) { results.clear(); });
-
-  for (const auto& i : results) {
-    INFO("HIP API Result check\n    File:: "
-         << i.file << "\n    Line:: " << i.line << "\n    API:: " << i.call
-         << "\n    Result:: " << i.result << "\n    Result Str:: " << hipGetErrorString(i.result));
-    REQUIRE(((i.result == hipSuccess) || (i.result == hipErrorPeerAccessAlreadyEnabled)));
-    REQUIRE(i.conditionsResult);
+  std::vector<HCResult> failures;
+  {
+    std::unique_lock<std::mutex> lock(resultMutex);
+    for (const auto& buffer : threadResults_) {
+      failures.insert(failures.end(), buffer->begin(), buffer->end());
+    }
+    // clear the results whatever happens
+    threadResults_.clear();
+    resultsGeneration_++;
   }
+  const size_t checks = threadChecks_.exchange(0);
   hasErrorOccured_.store(false);  // Clear the flag
+
+  for (const auto& i : failures) {
+    UNSCOPED_INFO("HIP API Result check\n    File:: "
+                  << i.file << "\n    Line:: " << i.line << "\n    API:: " << i.call
+                  << "\n    Result:: " << i.result
+                  << "\n    Result Str:: " << hipGetErrorString(i.result)
+                  << "\n    Condition:: " << (i.conditionsResult ? "true" : "false"));
+  }
+  INFO(failures.size() << " of " << checks << " threaded checks failed");
+  REQUIRE(failures.empty());
 }
 
 bool TestContext::hasErrorOccured() { return hasErrorOccured_.load(); }
 
+void TestContext::addForkChildHook(std::function<void()> hook) {
+  forkChildHooks_.push_back(std::move(hook));
+}
+
+void TestContext::initForkChild() {
+  hipError_t error = hipInit(0);
+  if (error != hipSuccess) {
+    LogPrintf("hipInit failed in the forked process: %s", hipGetErrorString(error));
+  }
+  for (const auto& hook : forkChildHooks_) hook();
+}
+
 TestContext::~TestContext() {
   // Show this message when there are unchecked results
-  if (results.size() != 0) {
+  const size_t checks = threadChecks_.load();
+  if (checks != 0) {
     std::cerr << "HIP_CHECK_THREAD_FINALIZE() has not been called after HIP_CHECK_THREAD\n"
               << "Please call HIP_CHECK_THREAD_FINALIZE after joining threads\n"
-              << "There is/are " << results.size() << " unchecked results from threads."
+              << "There is/are " << checks << " unchecked results from threads."
               << std::endl;
     std::abort();  // Crash to bring users attention to this message and avoid accidental passing of
                    // tests without checking for errors
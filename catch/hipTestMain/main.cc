@@ -1,11 +1,394 @@
 #define CATCH_CONFIG_RUNNER
+#include <algorithm>
+#include <chrono>
 #include <cmd_options.hh>
+#include <cstdlib>
+#include <hip_test_batch.hh>
 #include <hip_test_common.hh>
+#include <hip_test_timings.hh>
 #include <iostream>
+#include <map>
+#include <performance_trace.hh>
+#include <sstream>
+
+#if defined(RTC_TESTING)
+#include <hip_test_rtc.hh>
+#endif
 
 CmdOptions cmd_options;
 
+// Adds a span per test case to the trace requested with --trace-out
+class TraceListener : public Catch::TestEventListenerBase {
+ public:
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void testCaseStarting(Catch::TestCaseInfo const& info) override {
+    TestEventListenerBase::testCaseStarting(info);
+    if (auto recorder = GetTraceRecorder()) start_ = recorder->Now();
+  }
+
+  void testCaseEnded(Catch::TestCaseStats const& stats) override {
+    if (auto recorder = GetTraceRecorder()) {
+      recorder->RecordThreadEvent(recorder->Intern(stats.testInfo.name), "test case", start_,
+                                  recorder->Now());
+    }
+    TestEventListenerBase::testCaseEnded(stats);
+  }
+
+ private:
+  int64_t start_ = 0;
+};
+CATCH_REGISTER_LISTENER(TraceListener)
+
+// Reports the test cases run by a batch child process, see --batch
+class BatchListener : public Catch::TestEventListenerBase {
+ public:
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void testCaseStarting(Catch::TestCaseInfo const& info) override {
+    TestEventListenerBase::testCaseStarting(info);
+    if (auto writer = GetBatchResultWriter()) {
+      TestContext::get().resetTestSkipped();
+      message_.clear();
+      start_ = std::chrono::steady_clock::now();
+      writer->Started(info.name);
+    }
+  }
+
+  bool assertionEnded(Catch::AssertionStats const& stats) override {
+    const auto& result = stats.assertionResult;
+    if (GetBatchResultWriter() && !result.isOk() && message_.empty()) {
+      std::stringstream message;
+      message << result.getSourceInfo() << ": ";
+      if (result.hasExpression()) message << result.getExpandedExpression() << " ";
+      message << result.getMessage();
+      message_ = message.str();
+    }
+    return TestEventListenerBase::assertionEnded(stats);
+  }
+
+  void testCaseEnded(Catch::TestCaseStats const& stats) override {
+    if (auto writer = GetBatchResultWriter()) {
+      BatchTestResult result;
+      result.name = stats.testInfo.name;
+      result.time =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+      result.message = message_;
+      const bool skipped = TestContext::get().isTestSkipped();
+      if (!stats.totals.assertions.allOk()) {
+        result.status = BatchTestStatus::kFailed;
+      } else {
+        result.status = skipped ? BatchTestStatus::kSkipped : BatchTestStatus::kPassed;
+      }
+      writer->Ended(result);
+    }
+    TestEventListenerBase::testCaseEnded(stats);
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+  std::string message_;
+};
+CATCH_REGISTER_LISTENER(BatchListener)
+
+// Approximately the start of the process, static objects are initialized before main
+static const auto process_start = std::chrono::steady_clock::now();
+
+// Timings of the test cases run by this process, reported with --slowest
+static std::vector<std::pair<std::string, TestTiming>> run_timings;
+
+// Records the wall time, setup time and result of every test case, see --timings-out
+class TimingsListener : public Catch::TestEventListenerBase {
+ public:
+  using TestEventListenerBase::TestEventListenerBase;
+
+  void testCaseStarting(Catch::TestCaseInfo const& info) override {
+    TestEventListenerBase::testCaseStarting(info);
+    TestContext::get().resetTestSkipped();
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  void testCaseEnded(Catch::TestCaseStats const& stats) override {
+    const auto end = std::chrono::steady_clock::now();
+    TestTiming timing;
+    timing.time = std::chrono::duration<double>(end - start_).count();
+    timing.setup = std::chrono::duration<double>(start_ - previous_end_).count();
+    if (!stats.totals.assertions.allOk()) {
+      timing.result = "failed";
+    } else {
+      timing.result = TestContext::get().isTestSkipped() ? "skipped" : "passed";
+    }
+    previous_end_ = end;
+
+    if (!cmd_options.timings_out.empty()) {
+      AppendTestTiming(cmd_options.timings_out, stats.testInfo.name, timing);
+    }
+    run_timings.emplace_back(stats.testInfo.name, timing);
+    TestEventListenerBase::testCaseEnded(stats);
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point previous_end_ = process_start;
+};
+CATCH_REGISTER_LISTENER(TimingsListener)
+
+// File name of the executable without directory and extension
+static std::string GetExecutableName(const std::string& exe) {
+  const auto slash = exe.find_last_of("/\\");
+  auto name = slash == std::string::npos ? exe : exe.substr(slash + 1);
+  const std::string extension = ".exe";
+  if (name.size() > extension.size() &&
+      name.compare(name.size() - extension.size(), extension.size(), extension) == 0) {
+    name.resize(name.size() - extension.size());
+  }
+  return name;
+}
+
+// Builds a Catch test spec matching exactly the given test case names
+static std::string GetTestNamesSpec(const std::vector<std::string>& names) {
+  std::string spec;
+  for (const auto& name : names) {
+    if (!spec.empty()) spec += ',';
+    spec += '"';
+    for (auto c : name) {
+      if (c == '"' || c == ',' || c == '\\') spec += '\\';
+      spec += c;
+    }
+    spec += '"';
+  }
+  return spec;
+}
+
+// Names of the test cases selected on the command line, in the order they run
+static std::vector<std::string> SelectTestCases(Catch::Config& config) {
+  const auto& spec = config.testSpec();
+  std::vector<std::string> tests;
+  for (const auto& test_case : Catch::getAllTestCasesSorted(config)) {
+    if (spec.hasFilters() ? !spec.matches(test_case) : test_case.isHidden()) continue;
+    tests.push_back(test_case.name);
+  }
+  return tests;
+}
+
+/**
+ * Removes the test cases disabled in the json config files from the test cases selected on the
+ * command line, so that they are also skipped when a binary runs several test cases.
+ * Returns false if every selected test case is disabled.
+ */
+static bool ExcludeDisabledTests(Catch::Session& session) {
+  auto& config = session.config();
+  if (config.listTests() || config.listTestNamesOnly() || config.listTags() ||
+      config.listReporters()) {
+    return true;
+  }
+
+  const auto& context = TestContext::get();
+  std::vector<std::string> selected, disabled;
+  for (const auto& test : SelectTestCases(config)) {
+    (context.skipTest(test) ? disabled : selected).push_back(test);
+  }
+  if (disabled.empty()) return true;
+  if (selected.empty()) return false;
+
+  for (const auto& name : disabled) {
+    std::cout << "Skipping disabled test case: " << name << std::endl;
+  }
+  auto data = session.configData();
+  if (config.testSpec().hasFilters()) {
+    // Separate entries are combined like space separated patterns, which must all match
+    data.testsOrTags = {GetTestNamesSpec(selected)};
+  } else {
+    // Exclude every disabled test case, keep the hidden test cases excluded as well
+    std::string exclusions;
+    for (const auto& name : disabled) exclusions += "~" + GetTestNamesSpec({name}) + " ";
+    data.testsOrTags = {exclusions + "~[.]"};
+  }
+  session.useConfigData(data);
+  return true;
+}
+
+/**
+ * Runs the enabled test cases with runner and reports the disabled ones as skipped. Prints the
+ * test cases that did not pass and a summary, and writes the --batch-junit report.
+ * Returns the exit code of the run.
+ */
+static int RunInChildProcesses(const std::vector<std::string>& tests, BatchRunner& runner,
+                               const std::string& exe) {
+  const auto& context = TestContext::get();
+  std::vector<std::string> enabled;
+  for (const auto& test : tests) {
+    if (!context.skipTest(test)) enabled.push_back(test);
+  }
+  const auto enabled_results = runner.Run(enabled);
+
+  std::vector<BatchTestResult> results;
+  auto next = enabled_results.begin();
+  for (const auto& test : tests) {
+    if (context.skipTest(test)) {
+      results.push_back({test, BatchTestStatus::kSkipped, 0, "Disabled in the config file"});
+    } else {
+      results.push_back(*next++);
+    }
+  }
+
+  std::map<BatchTestStatus, size_t> counts;
+  for (const auto& result : results) {
+    ++counts[result.status];
+    if (result.status != BatchTestStatus::kPassed) {
+      std::cout << GetBatchTestStatusName(result.status) << ": " << result.name
+                << (result.message.empty() ? "" : " - " + result.message) << std::endl;
+    }
+  }
+  std::cout << results.size() << " test cases in " << runner.launches() << " processes, "
+            << counts[BatchTestStatus::kPassed] << " passed, "
+            << counts[BatchTestStatus::kFailed] << " failed, "
+            << counts[BatchTestStatus::kSkipped] << " skipped, "
+            << counts[BatchTestStatus::kCrashed] << " crashed, "
+            << counts[BatchTestStatus::kNotRun] << " not run" << std::endl;
+
+  if (!cmd_options.batch_junit.empty()) {
+    if (!WriteJUnitReport(cmd_options.batch_junit, GetExecutableName(exe), results)) {
+      std::cerr << "Unable to write JUnit report: " << cmd_options.batch_junit << std::endl;
+    }
+  }
+
+  std::vector<std::pair<std::string, TestTiming>> timings;
+  for (const auto& result : results) {
+    TestTiming timing;
+    timing.time = result.time;
+    timing.result = GetBatchTestStatusName(result.status);
+    timings.emplace_back(result.name, timing);
+  }
+  PrintSlowestTests(std::cout, timings, std::max(cmd_options.slowest, 0));
+
+  const size_t passed = counts[BatchTestStatus::kPassed] + counts[BatchTestStatus::kSkipped];
+  return passed == results.size() ? 0 : 1;
+}
+
+/**
+ * Compiles the RTC kernels of all tests concurrently with --rtc-precompile. Without load they
+ * are only stored in the disk cache, for the child processes of the batch and fork-server modes.
+ */
+static void PrecompileKernels(bool load = true) {
+  if (!cmd_options.rtc_precompile) return;
+#if defined(RTC_TESTING)
+  const size_t threads = std::max(cmd_options.rtc_precompile_threads, 0);
+  const auto start = std::chrono::steady_clock::now();
+  const auto results = HipTest::precompileRTCKernels(threads, load);
+  const double time =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  HipTest::printPrecompileReport(std::cout, results, time,
+                                 GetParallelThreads(results.size(), threads));
+#else
+  std::cout << "--rtc-precompile has no effect, the tests are not built with RTC_TESTING"
+            << std::endl;
+#endif
+}
+
+// Runs the test cases listed in the --batch file in child processes started with --batch-child
+static int RunBatch(const std::string& exe) {
+  const auto tests = ReadTestList(cmd_options.batch);
+  if (tests.empty()) {
+    std::cerr << "No test cases found in batch file: " << cmd_options.batch << std::endl;
+    return 1;
+  }
+
+  PrecompileKernels(false);
+  const std::string results = cmd_options.batch + ".results";
+  BatchRunner runner([&exe, &results](const std::vector<std::string>& batch) {
+    const std::string list = results + ".tests";
+    WriteTestList(list, batch);
+    std::remove(results.c_str());
+    std::string command = "\"" + exe + "\" --batch-child \"" + results + "\"";
+    if (!cmd_options.timings_out.empty()) {
+      command += " --timings-out \"" + cmd_options.timings_out + "\"";
+    }
+    BatchLaunch launch;
+#if defined(_WIN32)
+    command = "\"" + command + "\"";  // cmd strips the outer quotes
+    launch.status = std::system(command.c_str());
+#else
+    launch.status = GetExitStatus(std::system(command.c_str()));
+#endif
+    launch.records = ReadBatchResults(results);
+    std::remove(list.c_str());
+    std::remove(results.c_str());
+    return launch;
+  });
+  return RunInChildProcesses(tests, runner, exe);
+}
+
+/**
+ * Restricts the selected test cases to shard --shard-index of --shard-count. Test cases are
+ * partitioned by their durations in --shard-timings, disabled test cases weigh nothing.
+ * Returns false if the shard has no test cases.
+ */
+static bool SelectShard(Catch::Session& session, const std::string& exe) {
+  const auto tests = SelectTestCases(session.config());
+  auto durations = EstimateDurations(tests, ReadTestTimings(cmd_options.shard_timings));
+  const auto& context = TestContext::get();
+  for (size_t i = 0; i < tests.size(); ++i) {
+    if (context.skipTest(tests[i])) durations[i] = 0;
+  }
+
+  const auto shard = GetShardTests(tests, durations, cmd_options.shard_index,
+                                   cmd_options.shard_count, GetExecutableName(exe));
+  if (shard.empty()) return false;
+  auto data = session.configData();
+  data.testsOrTags = {GetTestNamesSpec(shard)};
+  session.useConfigData(data);
+  return true;
+}
+
+/**
+ * Runs the selected test cases in child processes forked from this one, --fork-group-size test
+ * cases per child. The config files and the test registry are only loaded once by this process,
+ * the children initialize the HIP runtime with TestContext::initForkChild.
+ */
+static int RunForkServer(Catch::Session& session, const std::string& exe) {
+#if defined(_WIN32)
+  std::cerr << "--fork-server is not supported on Windows" << std::endl;
+  return 1;
+#else
+  const auto tests = SelectTestCases(session.config());
+  if (tests.empty()) {
+    std::cerr << "No test cases matched" << std::endl;
+    return 1;
+  }
+
+  // This process does not initialize the HIP runtime, the kernels are compiled by a child
+  if (cmd_options.rtc_precompile) {
+    ForkAndRun({}, [](const std::vector<std::string>&, std::unique_ptr<BatchResultWriter>) {
+      TestContext::get().initForkChild();
+      PrecompileKernels(false);
+      return 0;
+    });
+  }
+
+  BatchRunner runner(
+      [&session](const std::vector<std::string>& group) {
+        return ForkAndRun(group, [&session](const std::vector<std::string>& tests,
+                                            std::unique_ptr<BatchResultWriter> writer) {
+          TestContext::get().initForkChild();
+          BatchResultWriterInstance() = std::move(writer);
+          auto data = session.configData();
+          data.testsOrTags = {GetTestNamesSpec(tests)};
+          session.useConfigData(data);
+          const int out = session.run();
+          TestContext::get().cleanContext();
+          Logger::get().flush();  // The child exits without running static destructors
+          return out;
+        });
+      },
+      std::max(cmd_options.fork_group_size, 1));
+  return RunInChildProcesses(tests, runner, exe);
+#endif
+}
+
 int main(int argc, char** argv) {
+  // Messages still in the logger are written out if a test case crashes or aborts
+  InstallLoggerCrashHandlers();
   auto& context = TestContext::get(argc, argv);
   if (context.skipTest()) {
     // CTest uses this regex to figure out if the test has been skipped
@@ -33,12 +416,148 @@ int main(int argc, char** argv) {
     | Opt(cmd_options.extended_run)
         ["-E"]["--extended-run"]
         ("TODO: Description goes here")
+    | Opt(cmd_options.benchmark_out, "path")
+        ["--benchmark-out"]
+        ("Append performance test results to a file, JSON Lines by default or CSV if the path "
+         "ends with .csv")
+    | Opt(cmd_options.benchmark_baseline, "path")
+        ["--benchmark-baseline"]
+        ("Compare performance test results against a file previously written with --benchmark-out")
+    | Opt(cmd_options.benchmark_threshold, "ratio")
+        ["--benchmark-threshold"]
+        ("Minimum relative change of the median reported as a regression or improvement "
+         "(default: 0.05)")
+    | Opt(cmd_options.benchmark_fail_on_regression)
+        ["--benchmark-fail-on-regression"]
+        ("Fail performance tests that regressed against the baseline")
+    | Opt(cmd_options.benchmark_reject_outliers)
+        ["--benchmark-reject-outliers"]
+        ("Exclude samples flagged as outliers (modified z-score above 3.5) from the mean, "
+         "standard deviation, fastest and slowest times")
+    | Opt(cmd_options.benchmark_min_time, "seconds")
+        ["--benchmark-min-time"]
+        ("Measure performance tests for at least this long, enables adaptive iteration counts")
+    | Opt(cmd_options.benchmark_max_time, "seconds")
+        ["--benchmark-max-time"]
+        ("Time budget of a performance test in adaptive mode (default: 10)")
+    | Opt(cmd_options.benchmark_target_rel_ci, "ratio")
+        ["--benchmark-target-rel-ci"]
+        ("Add iterations until the 95% confidence interval of the median is narrower than this "
+         "fraction of the median, enables adaptive iteration counts")
+    | Opt(cmd_options.benchmark_sweep_filter, "filter")
+        ["--benchmark-sweep-filter"]
+        ("Only run the sweep points matching axis=value[|value...][;axis=value...]")
+    | Opt(cmd_options.benchmark_subtract_overhead)
+        ["--benchmark-subtract-overhead"]
+        ("Subtract the calibrated overhead of the timers from the measured times")
+    | Opt(cmd_options.benchmark_perf_counters)
+        ["--benchmark-perf-counters"]
+        ("Report Linux perf counters (cycles, instructions, context switches, page faults, "
+         "cache misses) per iteration of CPU timed sections")
+    | Opt(cmd_options.trace_out, "path")
+        ["--trace-out"]
+        ("Write a Chrome trace event timeline of the test cases, benchmark iterations and timed "
+         "sections to this file")
+    | Opt(cmd_options.batch, "file")
+        ["--batch"]
+        ("Run the test cases listed in this file, one per line, in as few processes as "
+         "possible. A test case that crashes the process is reported and the remaining test "
+         "cases continue in a new process")
+    | Opt(cmd_options.batch_junit, "path")
+        ["--batch-junit"]
+        ("Write a JUnit report of the test cases run with --batch or --fork-server to this file")
+    | Opt(cmd_options.batch_child, "path")
+        ["--batch-child"]
+        ("Used by --batch: run the test cases listed in <path>.tests and append their results "
+         "to <path>")
+    | Opt(cmd_options.fork_server)
+        ["--fork-server"]
+        ("Load the config once and run the selected test cases in forked child processes, so "
+         "that a crashing test case does not affect the others (Linux only)")
+    | Opt(cmd_options.fork_group_size, "count")
+        ["--fork-group-size"]
+        ("Number of test cases run by each child process of --fork-server (default: 1)")
+    | Opt(cmd_options.shard_index, "index")
+        ["--shard-index"]
+        ("Only run the test cases of this shard, in [0, --shard-count)")
+    | Opt(cmd_options.shard_count, "count")
+        ["--shard-count"]
+        ("Split the selected test cases into this many shards of similar duration")
+    | Opt(cmd_options.shard_timings, "path")
+        ["--shard-timings"]
+        ("Durations of the test cases used to balance the shards, written with --timings-out")
+    | Opt(cmd_options.timings_out, "path")
+        ["--timings-out"]
+        ("Append the wall time, setup time and result of every test case to this file")
+    | Opt(cmd_options.slowest, "count")
+        ["--slowest"]
+        ("Print the given number of slowest test cases at the end of the run")
+    | Opt(cmd_options.rtc_precompile)
+        ["--rtc-precompile"]
+        ("With RTC_TESTING, compile the kernels of all tests concurrently before running the "
+         "test cases and report the compile time of every kernel")
+    | Opt(cmd_options.rtc_precompile_threads, "count")
+        ["--rtc-precompile-threads"]
+        ("Number of threads compiling kernels for --rtc-precompile (default: one per hardware "
+         "thread)")
   ;
   // clang-format on
 
   session.cli(cli);
 
-  int out = session.run(argc, argv);
+  int out = session.applyCommandLine(argc, argv);
+  if (out != 0) return out;
+
+  if (!cmd_options.batch.empty()) return RunBatch(argv[0]);
+  if (cmd_options.shard_count > 0) {
+    if (cmd_options.shard_index < 0 || cmd_options.shard_index >= cmd_options.shard_count) {
+      std::cerr << "--shard-index must be in [0, " << cmd_options.shard_count << ")" << std::endl;
+      return 1;
+    }
+    if (!SelectShard(session, argv[0])) {
+      if (!session.config().listTestNamesOnly() && !session.config().listTests()) {
+        std::cout << "No test cases in shard " << cmd_options.shard_index << " of "
+                  << cmd_options.shard_count << std::endl;
+      }
+      return 0;
+    }
+  }
+
+  if (cmd_options.fork_server) return RunForkServer(session, argv[0]);
+
+  if (!cmd_options.batch_child.empty()) {
+    auto data = session.configData();
+    data.testsOrTags = {GetTestNamesSpec(ReadTestList(cmd_options.batch_child + ".tests"))};
+    session.useConfigData(data);
+    BatchResultWriterInstance() = std::make_unique<BatchResultWriter>(cmd_options.batch_child);
+  }
+
+  if (!ExcludeDisabledTests(session)) {
+    std::cout << "HIP_SKIP_THIS_TEST" << std::endl;
+    return 0;
+  }
+
+  if (!cmd_options.trace_out.empty()) {
+    TraceRecorderInstance() = std::make_unique<TraceRecorder>();
+  }
+
+  const auto& config = session.config();
+  if (!config.listTests() && !config.listTestNamesOnly() && !config.listTags()) {
+    PrecompileKernels();
+  }
+
+  out = session.run();
   TestContext::get().cleanContext();
+  PrintSlowestTests(std::cout, run_timings, std::max(cmd_options.slowest, 0));
+
+  if (auto recorder = GetTraceRecorder()) {
+    if (recorder->dropped() > 0) {
+      std::cerr << "Trace buffer full, dropped the " << recorder->dropped() << " oldest events"
+                << std::endl;
+    }
+    if (!recorder->Write(cmd_options.trace_out)) {
+      std::cerr << "Unable to write trace: " << cmd_options.trace_out << std::endl;
+    }
+  }
   return out;
 }
@@ -22,12 +22,38 @@ THE SOFTWARE.
 
 #pragma once
 
+#include <string>
+
 struct CmdOptions {
   int iterations = 1000;
   int warmups = 100;
   bool no_display = false;
   bool progress = false;
   bool extended_run = false;
+  std::string benchmark_out;
+  std::string benchmark_baseline;
+  float benchmark_threshold = 0.05f;
+  bool benchmark_fail_on_regression = false;
+  bool benchmark_reject_outliers = false;
+  double benchmark_min_time = 0;
+  double benchmark_max_time = 0;
+  double benchmark_target_rel_ci = 0;
+  std::string benchmark_sweep_filter;
+  bool benchmark_subtract_overhead = false;
+  bool benchmark_perf_counters = false;
+  std::string trace_out;
+  std::string batch;
+  std::string batch_junit;
+  std::string batch_child;
+  bool fork_server = false;
+  int fork_group_size = 1;
+  int shard_index = 0;
+  int shard_count = 0;
+  std::string shard_timings;
+  std::string timings_out;
+  int slowest = 0;
+  bool rtc_precompile = false;
+  int rtc_precompile_threads = 0;
 };
 
 extern CmdOptions cmd_options;
\ No newline at end of file
@@ -0,0 +1,458 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <iostream>
+#endif
+
+/**
+ * Host only harness of the --batch and --fork-server modes, which run test cases in child processes
+ * without starting the executable once per test case. A child writes a record before and after
+ * every test case, to a results file or a pipe; if the child dies, the test case it was running is
+ * reported as crashed and a new child runs the remaining ones.
+ */
+
+enum class BatchTestStatus { kPassed, kFailed, kSkipped, kCrashed, kNotRun };
+
+inline std::string GetBatchTestStatusName(BatchTestStatus status) {
+  switch (status) {
+    case BatchTestStatus::kPassed:
+      return "passed";
+    case BatchTestStatus::kFailed:
+      return "failed";
+    case BatchTestStatus::kSkipped:
+      return "skipped";
+    case BatchTestStatus::kCrashed:
+      return "crashed";
+    case BatchTestStatus::kNotRun:
+      return "not run";
+    default:
+      return "unknown";
+  }
+}
+
+struct BatchTestResult {
+  std::string name;
+  BatchTestStatus status = BatchTestStatus::kNotRun;
+  double time = 0;  // Seconds
+  std::string message;
+};
+
+// Fields of the records are tab separated, tabs, line breaks and backslashes are escaped
+inline std::string EscapeBatchField(const std::string& field) {
+  std::string escaped;
+  escaped.reserve(field.size());
+  for (auto c : field) {
+    switch (c) {
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\t':
+        escaped += "\\t";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      case '\r':
+        escaped += "\\r";
+        break;
+      default:
+        escaped += c;
+    }
+  }
+  return escaped;
+}
+
+inline std::string UnescapeBatchField(const std::string& field) {
+  std::string unescaped;
+  unescaped.reserve(field.size());
+  for (size_t i = 0; i < field.size(); ++i) {
+    if (field[i] != '\\' || i + 1 == field.size()) {
+      unescaped += field[i];
+      continue;
+    }
+    switch (field[++i]) {
+      case 't':
+        unescaped += '\t';
+        break;
+      case 'n':
+        unescaped += '\n';
+        break;
+      case 'r':
+        unescaped += '\r';
+        break;
+      default:
+        unescaped += field[i];
+    }
+  }
+  return unescaped;
+}
+
+/**
+ * @brief Reads a list of test case names, one per line. Empty lines are ignored.
+ */
+inline std::vector<std::string> ReadTestList(const std::string& path) {
+  std::vector<std::string> tests;
+  std::ifstream in(path);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (!line.empty()) tests.push_back(line);
+  }
+  return tests;
+}
+
+inline bool WriteTestList(const std::string& path, const std::vector<std::string>& tests) {
+  std::ofstream out(path);
+  for (const auto& test : tests) out << test << '\n';
+  return static_cast<bool>(out);
+}
+
+/**
+ * @brief Writes the progress of the test cases run in a batch child process, a record before and
+ * after every test case. Records go to a results file, where each one is flushed so that the file
+ * is complete up to the point where the process died, or to a custom sink such as a pipe.
+ */
+class BatchResultWriter {
+ public:
+  using Sink = std::function<void(const std::string& record)>;
+
+  explicit BatchResultWriter(Sink sink) : sink_(std::move(sink)) {}
+
+  explicit BatchResultWriter(const std::string& path)
+      : sink_([out = std::make_shared<std::ofstream>(path, std::ios::app)](
+                  const std::string& record) { *out << record << std::flush; }) {}
+
+  void Started(const std::string& name) { sink_("start\t" + EscapeBatchField(name) + "\n"); }
+
+  void Ended(const BatchTestResult& result) {
+    std::stringstream record;
+    record << "end\t" << EscapeBatchField(result.name) << '\t' << static_cast<int>(result.status)
+           << '\t' << result.time << '\t' << EscapeBatchField(result.message) << '\n';
+    sink_(record.str());
+  }
+
+ private:
+  Sink sink_;
+};
+
+/**
+ * @brief Parses the records written by BatchResultWriter, in the order the test cases started.
+ * A test case that started but never ended is returned as crashed.
+ */
+inline std::vector<BatchTestResult> ParseBatchResults(std::istream& in) {
+  std::vector<BatchTestResult> results;
+  std::unordered_map<std::string, size_t> running;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::vector<std::string> fields;
+    std::stringstream record(line);
+    std::string field;
+    while (std::getline(record, field, '\t')) fields.push_back(UnescapeBatchField(field));
+    if (fields.size() == 2 && fields[0] == "start") {
+      running[fields[1]] = results.size();
+      results.push_back({fields[1], BatchTestStatus::kCrashed, 0,
+                         "The test process exited before the test case ended"});
+    } else if (fields.size() >= 4 && fields[0] == "end") {
+      auto it = running.find(fields[1]);
+      const int status = std::atoi(fields[2].c_str());
+      if (it == running.end() || status < 0 ||
+          status > static_cast<int>(BatchTestStatus::kNotRun)) {
+        continue;
+      }
+      auto& result = results[it->second];
+      result.status = static_cast<BatchTestStatus>(status);
+      result.time = std::atof(fields[3].c_str());
+      result.message = fields.size() > 4 ? fields[4] : "";
+      running.erase(it);
+    }
+  }
+  return results;
+}
+
+inline std::vector<BatchTestResult> ReadBatchResults(const std::string& path) {
+  std::ifstream in(path);
+  return ParseBatchResults(in);
+}
+
+inline std::string EscapeXml(const std::string& text) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (auto c : text) {
+    switch (c) {
+      case '&':
+        escaped += "&amp;";
+        break;
+      case '<':
+        escaped += "&lt;";
+        break;
+      case '>':
+        escaped += "&gt;";
+        break;
+      case '"':
+        escaped += "&quot;";
+        break;
+      case '\'':
+        escaped += "&apos;";
+        break;
+      default:
+        escaped += c;
+    }
+  }
+  return escaped;
+}
+
+/**
+ * @brief Writes a JUnit report with a testcase per test case. Crashed test cases and test cases
+ * that could not be run are reported as errors.
+ */
+inline bool WriteJUnitReport(const std::string& path, const std::string& suite,
+                             const std::vector<BatchTestResult>& results) {
+  size_t failures = 0, errors = 0, skipped = 0;
+  double time = 0;
+  for (const auto& result : results) {
+    failures += result.status == BatchTestStatus::kFailed;
+    errors += result.status == BatchTestStatus::kCrashed ||
+        result.status == BatchTestStatus::kNotRun;
+    skipped += result.status == BatchTestStatus::kSkipped;
+    time += result.time;
+  }
+
+  std::ofstream out(path);
+  out << std::fixed << std::setprecision(3);
+  out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n";
+  out << "  <testsuite name=\"" << EscapeXml(suite) << "\" tests=\"" << results.size()
+      << "\" failures=\"" << failures << "\" errors=\"" << errors << "\" skipped=\"" << skipped
+      << "\" time=\"" << time << "\">\n";
+  for (const auto& result : results) {
+    out << "    <testcase classname=\"" << EscapeXml(suite) << "\" name=\""
+        << EscapeXml(result.name) << "\" time=\"" << result.time << "\"";
+    const std::string message = EscapeXml(result.message);
+    switch (result.status) {
+      case BatchTestStatus::kPassed:
+        out << "/>\n";
+        continue;
+      case BatchTestStatus::kFailed:
+        out << ">\n      <failure message=\"" << message << "\"/>\n";
+        break;
+      case BatchTestStatus::kSkipped:
+        out << ">\n      <skipped message=\"" << message << "\"/>\n";
+        break;
+      default:
+        out << ">\n      <error type=\"" << GetBatchTestStatusName(result.status)
+            << "\" message=\"" << message << "\"/>\n";
+    }
+    out << "    </testcase>\n";
+  }
+  out << "  </testsuite>\n</testsuites>\n";
+  return static_cast<bool>(out);
+}
+
+// Outcome of a process started to run test cases
+struct BatchLaunch {
+  int status = 0;  // Exit status of the process, 128 + the signal number if it was killed
+  std::vector<BatchTestResult> records;  // Records written by the process, see BatchResultWriter
+};
+
+/**
+ * @brief Runs test cases in as few child processes as possible.
+ *
+ * The launcher runs the given test cases in a single process which reports its progress with a
+ * BatchResultWriter. Test cases that were not reached because the process died are handed to a new
+ * launch.
+ */
+class BatchRunner {
+ public:
+  using Launcher = std::function<BatchLaunch(const std::vector<std::string>& tests)>;
+
+  /**
+   * @param launch Runs test cases in a new process.
+   * @param group_size Maximum number of test cases per process, 0 for no limit.
+   */
+  explicit BatchRunner(Launcher launch, size_t group_size = 0)
+      : launch_(std::move(launch)), group_size_(group_size) {}
+
+  /**
+   * @return the results in the order of tests, which are expected to be unique.
+   */
+  std::vector<BatchTestResult> Run(const std::vector<std::string>& tests) {
+    std::vector<BatchTestResult> results(tests.size());
+    std::unordered_map<std::string, size_t> index;
+    for (size_t i = 0; i < tests.size(); ++i) {
+      results[i].name = tests[i];
+      index[tests[i]] = i;
+    }
+
+    const size_t group_size = group_size_ > 0 ? group_size_ : tests.size();
+    for (size_t begin = 0; begin < tests.size(); begin += group_size) {
+      const auto end = tests.begin() + std::min(begin + group_size, tests.size());
+      std::vector<std::string> remaining(tests.begin() + begin, end);
+      while (!remaining.empty()) {
+        const auto launch = launch_(remaining);
+        ++launches_;
+
+        std::unordered_set<std::string> finished;
+        for (auto record : launch.records) {
+          auto it = index.find(record.name);
+          if (it == index.end() || finished.count(record.name)) continue;
+          if (record.status == BatchTestStatus::kCrashed) {
+            record.message += ", exit status " + std::to_string(launch.status);
+          }
+          results[it->second] = record;
+          finished.insert(record.name);
+        }
+
+        // Nothing was run, launching again would not make progress
+        if (finished.empty()) {
+          for (const auto& test : remaining) {
+            results[index[test]].message = "The test process exited with status " +
+                std::to_string(launch.status) + " without running the test case";
+          }
+          break;
+        }
+
+        std::vector<std::string> next;
+        for (const auto& test : remaining) {
+          if (!finished.count(test)) next.push_back(test);
+        }
+        remaining.swap(next);
+      }
+    }
+    return results;
+  }
+
+  // Number of processes launched by Run
+  size_t launches() const { return launches_; }
+
+ private:
+  Launcher launch_;
+  size_t group_size_;
+  size_t launches_ = 0;
+};
+
+#if !defined(_WIN32)
+// Exit status of a process as reported by a shell, 128 + the signal number if it was killed
+inline int GetExitStatus(int wait_status) {
+  if (WIFEXITED(wait_status)) return WEXITSTATUS(wait_status);
+  if (WIFSIGNALED(wait_status)) return 128 + WTERMSIG(wait_status);
+  return wait_status;
+}
+
+/**
+ * @brief Runs test cases in a forked child process, which streams its records back over a pipe.
+ * Everything set up before the call is inherited by the child. The child exits with the value
+ * returned by child and never returns from this function.
+ */
+inline BatchLaunch ForkAndRun(
+    const std::vector<std::string>& tests,
+    const std::function<int(const std::vector<std::string>& tests,
+                            std::unique_ptr<BatchResultWriter> writer)>& child) {
+  BatchLaunch launch;
+  int fds[2];
+  if (pipe(fds) != 0) {
+    launch.status = -1;
+    return launch;
+  }
+
+  // Buffered output would be written by both processes otherwise
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(nullptr);
+
+  const pid_t pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    launch.status = -1;
+    return launch;
+  }
+
+  if (pid == 0) {
+    close(fds[0]);
+    const int fd = fds[1];
+    auto writer = std::make_unique<BatchResultWriter>([fd](const std::string& record) {
+      for (size_t written = 0; written < record.size();) {
+        const auto count = write(fd, record.data() + written, record.size() - written);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return;
+        written += count;
+      }
+    });
+    int status = 1;
+    try {
+      status = child(tests, std::move(writer));
+    } catch (...) {
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    _exit(status);
+  }
+
+  close(fds[1]);
+  std::string records;
+  char buffer[4096];
+  for (;;) {
+    const auto count = read(fds[0], buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR) continue;
+    if (count <= 0) break;
+    records.append(buffer, count);
+  }
+  close(fds[0]);
+
+  int wait_status = 0;
+  while (waitpid(pid, &wait_status, 0) < 0 && errno == EINTR) {
+  }
+  launch.status = GetExitStatus(wait_status);
+  std::stringstream in(records);
+  launch.records = ParseBatchResults(in);
+  return launch;
+}
+#endif
+
+inline std::unique_ptr<BatchResultWriter>& BatchResultWriterInstance() {
+  static std::unique_ptr<BatchResultWriter> writer;
+  return writer;
+}
+
+// The results writer of a batch child process, nullptr if this process is not one
+inline BatchResultWriter* GetBatchResultWriter() { return BatchResultWriterInstance().get(); }
@@ -242,6 +242,7 @@ inline bool isImageSupported() {
 static inline void HIP_SKIP_TEST(char const* const reason) noexcept {
   // ctest is setup to parse for "HIP_SKIP_THIS_TEST", at which point it will skip the test.
   std::cout << "Skipping test. Reason: " << reason << '\n' << "HIP_SKIP_THIS_TEST" << std::endl;
+  TestContext::get().markTestSkipped();
 }
 
 /**
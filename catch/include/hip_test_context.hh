@@ -25,6 +25,9 @@ THE SOFTWARE.
 #include <hip/hiprtc.h>
 
 #include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <vector>
 #include <iostream>
@@ -32,6 +35,9 @@ THE SOFTWARE.
 #include <set>
 #include <unordered_map>
 
+#include "hip_test_logger.hh"
+#include "hip_test_name_matcher.hh"
+
 // OS Check
 #if defined(_WIN32)
 #define HT_WIN 1
@@ -60,15 +66,20 @@ typedef struct Config_ {
   std::string os;         // windows/linux
 } Config;
 
-// Store Multi threaded results
+// Store Multi threaded results. file and call point to the string literals of the check macros,
+// so recording a result does not allocate
 struct HCResult {
   size_t line;            // Line of check (HIP_CHECK_THREAD or REQUIRE_THREAD)
-  std::string file;       // File name of the check
+  const char* file;       // File name of the check
   hipError_t result;      // hipResult for HIP_CHECK_THREAD, for conditions its hipSuccess
-  std::string call;       // Call of HIP API or a bool condition
+  const char* call;       // Call of HIP API or a bool condition
   bool conditionsResult;  // If bool condition, result of call. For HIP Calls its true
-  HCResult(size_t l, std::string f, hipError_t r, std::string c, bool b = true)
+  HCResult(size_t l, const char* f, hipError_t r, const char* c, bool b = true)
       : line(l), file(f), result(r), call(c), conditionsResult(b) {}
+
+  bool passed() const {
+    return conditionsResult && (result == hipSuccess || result == hipErrorPeerAccessAlreadyEnabled);
+  }
 };
 
 
@@ -76,8 +87,9 @@ class TestContext {
   bool p_windows = false, p_linux = false;  // OS
   bool amd = false, nvidia = false;         // HIP Platform
   std::string exe_path;
+  std::string exe_file;  // Absolute path of the test executable
   std::string current_test;
-  std::set<std::string> skip_test;
+  TestNameMatcher skip_test;  // DisabledTests of the json files, compiled once
   std::string json_file_;
   std::vector<std::string> platform_list_ = {"amd", "nvidia"};
   std::vector<std::string> os_list_ = {"windows", "linux", "all"};
@@ -89,6 +101,10 @@ class TestContext {
   };
 
   std::unordered_map<std::string, rtcState> compiledKernels{};
+  std::atomic<uint64_t> rtcGeneration_{0};  // Incremented whenever the modules are unloaded
+
+  std::unordered_map<std::string, std::string> build_info_;
+  bool build_info_loaded_ = false;
 
   Config config_;
   std::string& getCommonJsonFile();
@@ -100,15 +116,25 @@ class TestContext {
   void parseOptions(int, char**);
   bool parseJsonFiles();
   std::string getMatchingConfigFile(std::string config_dir);
+  void loadBuildInfo();
   const Config& getConfig() const { return config_; }
 
 
   TestContext(int argc, char** argv);
 
-  // Multi threaded checks helpers
-  std::mutex resultMutex;
-  std::vector<HCResult> results;  // Multi threaded test results buffer
+  // Multi threaded checks helpers. Passed checks are only counted, failed checks are stored in a
+  // buffer of the checking thread, so that threads do not contend on the harness
+  std::atomic<size_t> threadChecks_{0};  // Checks since the last finalizeResults
+  std::mutex resultMutex;                // Guards threadResults_
+  std::vector<std::unique_ptr<std::vector<HCResult>>> threadResults_;  // Failures per thread
+  std::atomic<uint64_t> resultsGeneration_{0};  // Incremented when threadResults_ is cleared
   std::atomic<bool> hasErrorOccured_{false};
+  std::vector<HCResult>& getThreadResults();
+  void addFailedResult(const HCResult& r);
+
+  std::atomic<bool> testSkipped_{false};  // Set by HIP_SKIP_TEST
+
+  std::vector<std::function<void()>> forkChildHooks_;
 
  public:
   static TestContext& get(int argc = 0, char** argv = nullptr) {
@@ -142,14 +168,57 @@ class TestContext {
   bool isAmd() const;
   bool skipTest() const;
 
+  /**
+   * @brief Check a test case name against the DisabledTests of the json config files.
+   *
+   * @param test_name The name of the test case, '*' in the disabled entries matches any sequence.
+   * @return true if the test case is disabled.
+   */
+  bool skipTest(const std::string& test_name) const;
+
   const std::string& getCurrentTest() const { return current_test; }
   std::string currentPath() const;
 
+  /**
+   * @brief Get the absolute path of the running test executable, e.g. to start it again with
+   * hip::SpawnProc. Resolved from argv[0] against the working directory at startup.
+   */
+  const std::string& getExeFile() const { return exe_file; }
+
+  /**
+   * @brief Get a value from the catchInfo.txt file generated at configure time.
+   *
+   * @param key The name of the entry (e.g. HIP_VERSION, HIP_TESTS_GITHASH).
+   * @return the value of the entry, empty if the file or the entry could not be found.
+   */
+  std::string getBuildInfo(const std::string& key);
+
   // Multi threaded results helpers
-  void addResults(HCResult r);  // Add multi threaded results
+  void addResults(const HCResult& r) {  // Add multi threaded results, lock free if passed
+    threadChecks_.fetch_add(1, std::memory_order_relaxed);
+    if (!r.passed()) addFailedResult(r);
+  }
   void finalizeResults();       // Validate on all results
   bool hasErrorOccured();       // Query if error has occured
 
+  // Skipped test helpers, used to report skipped test cases when several run in one process
+  void markTestSkipped() { testSkipped_.store(true); }
+  void resetTestSkipped() { testSkipped_.store(false); }
+  bool isTestSkipped() const { return testSkipped_.load(); }
+
+  /**
+   * @brief Register a function run in every child process forked by --fork-server, after the HIP
+   * runtime has been initialized and before the test cases run. Use it to set up state that does
+   * not survive a fork.
+   */
+  void addForkChildHook(std::function<void()> hook);
+
+  /**
+   * @brief Initialize a child process forked by --fork-server. The parent process does not use the
+   * HIP runtime, so it is initialized here, followed by the registered hooks.
+   */
+  void initForkChild();
+
   /**
    * @brief Unload all loaded modules.
    * Note: This function needs to be called at the end of each test that uses RTC.
@@ -178,19 +247,17 @@ class TestContext {
    */
   hipFunction_t getFunction(const std::string kernelNameExpression);
 
+  /**
+   * @brief Number of times the rtc modules have been unloaded. Functions cached outside of the
+   * context are only valid while the generation they were looked up in is current.
+   */
+  uint64_t getRtcGeneration() const { return rtcGeneration_.load(std::memory_order_acquire); }
+
   TestContext(const TestContext&) = delete;
   void operator=(const TestContext&) = delete;
 
   ~TestContext();
 };
 
-static bool _log_enable = (!TestContext::getEnvVar("HT_LOG_ENABLE").empty() ? true : false);
-
-// printing logs
-#define LogPrintf(format, ...)                                                                   \
-{                                                                                                \
-  if(_log_enable) {                                                                              \
-    printf(format, __VA_ARGS__);                                                                 \
-    printf("%c", '\n');                                                                          \
-  }                                                                                              \
-}
+// printing logs, kept for compatibility with the asynchronous logger of hip_test_logger.hh
+#define LogPrintf(format, ...) LogInfo(format, __VA_ARGS__)
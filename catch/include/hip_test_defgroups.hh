@@ -129,6 +129,13 @@ THE SOFTWARE.
  * @}
  */
 
+/**
+ * @defgroup TestFrameworkTest Test Framework
+ * @{
+ * This section describes host only tests of the test infrastructure in hipTestMain.
+ * @}
+ */
+
 /**
  * @defgroup TextureTest Texture Management
  * @{
@@ -0,0 +1,89 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace HipTest {
+
+/**
+ * @brief Layout of kernel arguments in the buffer passed to hipModuleLaunchKernel, computed at
+ * compile time. Every argument is placed at the next offset satisfying its alignment.
+ *
+ * @tparam Args The types of the kernel arguments, without references.
+ */
+template <typename... Args> class KernelArgumentLayout {
+  static constexpr size_t kSizes[] = {sizeof(Args)..., 0};
+  static constexpr size_t kAlignments[] = {alignof(Args)..., 1};
+
+  // Offsets of the arguments, followed by the end of the last argument
+  static constexpr std::array<size_t, sizeof...(Args) + 1> getOffsets() {
+    std::array<size_t, sizeof...(Args) + 1> offsets{};
+    size_t offset = 0;
+    for (size_t i = 0; i < sizeof...(Args); ++i) {
+      offset = (offset + kAlignments[i] - 1) & ~(kAlignments[i] - 1);
+      offsets[i] = offset;
+      offset += kSizes[i];
+    }
+    offsets[sizeof...(Args)] = offset;
+    return offsets;
+  }
+
+ public:
+  static constexpr size_t count = sizeof...(Args);
+  static constexpr std::array<size_t, sizeof...(Args) + 1> offsets = getOffsets();
+  // The buffer is not padded beyond the last argument
+  static constexpr size_t size = offsets[sizeof...(Args)];
+  static constexpr size_t alignment = std::max({size_t{1}, alignof(Args)...});
+};
+
+/**
+ * @brief Kernel arguments packed in a buffer on the stack, laid out by KernelArgumentLayout.
+ */
+template <typename... Args> class PackedKernelArguments {
+ public:
+  using Layout = KernelArgumentLayout<std::remove_cv_t<std::remove_reference_t<Args>>...>;
+
+  explicit PackedKernelArguments(const Args&... args) {
+    pack(std::index_sequence_for<Args...>{}, args...);
+  }
+
+  void* data() { return buffer_; }
+  size_t* size() { return &size_; }
+
+ private:
+  template <size_t... Index>
+  void pack(std::index_sequence<Index...>, const Args&... args) {
+    (std::memcpy(buffer_ + Layout::offsets[Index], &args, sizeof(args)), ...);
+  }
+
+  alignas(Layout::alignment) char buffer_[Layout::size > 0 ? Layout::size : 1];
+  size_t size_ = Layout::size;
+};
+
+}  // namespace HipTest
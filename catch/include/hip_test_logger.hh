@@ -0,0 +1,592 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <memory>
+#include <new>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Asynchronous logger of the test framework. A logging thread formats its message into a ring
+ * buffer of its own and returns, a background thread drains the rings of all threads in time order
+ * and writes them to a file, stderr by default. Logging therefore neither locks nor allocates after
+ * the first message of a thread, messages longer than a record continue in the following records.
+ * Messages logged while the ring of a thread is full are dropped and counted.
+ *
+ * The logger of the test framework writes to stdout like LogPrintf always did. It is configured
+ * with environment variables:
+ *   HT_LOG_LEVEL  : debug, info, warning, error or off
+ *   HT_LOG_ENABLE : any value, same as HT_LOG_LEVEL=debug if HT_LOG_LEVEL is not set
+ *   HT_LOG_FILE   : file the messages are appended to instead of stdout
+ */
+
+enum class LogLevel { kDebug, kInfo, kWarning, kError, kOff };
+
+inline const char* GetLogLevelName(LogLevel level) {
+  switch (level) {
+    case LogLevel::kDebug:
+      return "DEBUG";
+    case LogLevel::kInfo:
+      return "INFO";
+    case LogLevel::kWarning:
+      return "WARNING";
+    case LogLevel::kError:
+      return "ERROR";
+    default:
+      return "OFF";
+  }
+}
+
+inline LogLevel ParseLogLevel(const std::string& name, LogLevel fallback = LogLevel::kOff) {
+  std::string lower = name;
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  if (lower == "debug") return LogLevel::kDebug;
+  if (lower == "info") return LogLevel::kInfo;
+  if (lower == "warning") return LogLevel::kWarning;
+  if (lower == "error") return LogLevel::kError;
+  if (lower == "off") return LogLevel::kOff;
+  return fallback;
+}
+
+constexpr size_t kLogMessageSize = 232;  // Longer messages are split over several records
+constexpr size_t kLogRingSize = 512;     // Records per thread
+
+struct LogRecord {
+  int64_t time;  // Nanoseconds since the logger started
+  uint32_t thread;
+  LogLevel level;
+  char message[kLogMessageSize];
+};
+
+/**
+ * @brief Single producer, single consumer ring of the records of one thread.
+ */
+class LogRing {
+  std::array<LogRecord, kLogRingSize> records_;
+  std::atomic<size_t> head_{0};  // Next record written by the owning thread
+  std::atomic<size_t> tail_{0};  // Next record read by the drain
+  std::atomic<size_t> dropped_{0};
+  std::atomic<bool> closed_{false};  // The owning thread exited
+  uint32_t thread_;
+
+ public:
+  explicit LogRing(uint32_t thread) : thread_(thread) {}
+
+  uint32_t thread() const { return thread_; }
+
+  // Returns the record to fill, nullptr if the ring is full
+  LogRecord* reserve() {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == kLogRingSize) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    return &records_[head % kLogRingSize];
+  }
+
+  void commit() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  // Passes every committed record to consume, only called by one thread at a time
+  template <typename Consumer> void drain(Consumer consume) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_acquire);
+    for (; tail != head; ++tail) consume(records_[tail % kLogRingSize]);
+    tail_.store(tail, std::memory_order_release);
+  }
+
+  // The oldest committed record, nullptr if there is none. Only called by the drain.
+  const LogRecord* front() const {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) return nullptr;
+    return &records_[tail % kLogRingSize];
+  }
+
+  // Consumes the record returned by front()
+  void pop() {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  // Drops the committed records without consuming them
+  void discard() { tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release); }
+
+  size_t takeDropped() { return dropped_.exchange(0, std::memory_order_relaxed); }
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+  }
+  void close() { closed_.store(true, std::memory_order_release); }
+  bool closed() const { return closed_.load(std::memory_order_acquire); }
+};
+
+/**
+ * @brief A formatted log line in a fixed buffer. Formatting neither allocates nor calls into stdio,
+ * so that the lines can be written from a signal handler.
+ */
+class LogLine {
+  char data_[kLogMessageSize + 96];
+  size_t size_ = 0;
+
+ public:
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  void append(const char* text, size_t length) {
+    length = std::min(length, sizeof(data_) - size_);
+    std::memcpy(data_ + size_, text, length);
+    size_ += length;
+  }
+  void append(const char* text) { append(text, std::strlen(text)); }
+
+  // Appends value in decimal, right aligned to width with fill
+  void appendNumber(uint64_t value, size_t width = 0, char fill = ' ') {
+    char digits[20];
+    size_t count = 0;
+    do {
+      digits[count++] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+    for (; width > count; --width) append(&fill, 1);
+    while (count > 0) append(&digits[--count], 1);
+  }
+};
+
+// "[seconds] [pid:thread] [LEVEL] message", the seconds since the logger started in microseconds
+inline void FormatLogRecord(const LogRecord& record, int pid, LogLine& line) {
+  const uint64_t micros = static_cast<uint64_t>(record.time) / 1000;
+  line.append("[");
+  line.appendNumber(micros / 1000000, 5);
+  line.append(".");
+  line.appendNumber(micros % 1000000, 6, '0');
+  line.append("] [");
+  line.appendNumber(static_cast<uint64_t>(pid));
+  line.append(":");
+  line.appendNumber(record.thread);
+  line.append("] [");
+  line.append(GetLogLevelName(record.level));
+  line.append("] ");
+  line.append(record.message,
+              std::find(record.message, record.message + kLogMessageSize, '\0') - record.message);
+  line.append("\n");
+}
+
+inline void FormatDroppedLogRecords(size_t dropped, int pid, LogLine& line) {
+  line.append("[");
+  line.appendNumber(static_cast<uint64_t>(pid));
+  line.append("] ");
+  line.appendNumber(dropped);
+  line.append(" log messages dropped\n");
+}
+
+// Writes to a file descriptor without buffering, async signal safe
+inline void WriteLogFile(int fd, const char* data, size_t size) {
+  while (size > 0) {
+#if defined(_WIN32)
+    const auto count = _write(fd, data, static_cast<unsigned>(size));
+#else
+    const auto count = ::write(fd, data, size);
+#endif
+    if (count < 0 && errno == EINTR) continue;
+    if (count <= 0) return;
+    data += count;
+    size -= count;
+  }
+}
+
+class Logger {
+  static inline std::atomic<uint64_t> next_id_{0};
+
+  const uint64_t id_ = next_id_++;
+  const std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+  std::atomic<LogLevel> level_;
+  const bool background_;
+
+  std::mutex mutex_;  // Guards rings_, out_ and the drain
+  std::vector<std::shared_ptr<LogRing>> rings_;
+  uint32_t next_thread_ = 0;
+  FILE* const default_out_;
+  FILE* out_;
+  int out_fd_;  // Descriptor of out_, written to by flushOnCrash
+  std::vector<LogRecord> pending_;
+  std::string buffer_;
+
+  std::mutex thread_mutex_;  // Guards the drain thread
+  std::condition_variable wake_;
+  std::unique_ptr<std::thread> thread_;
+  bool stop_ = false;
+
+  // The ring of the calling thread, registered on its first message
+  LogRing* getRing() {
+    struct ThreadRing {
+      uint64_t logger = UINT64_MAX;
+      std::shared_ptr<LogRing> ring;
+      ~ThreadRing() {
+        if (ring) ring->close();
+      }
+    };
+    thread_local ThreadRing current;
+    if (current.logger != id_) {
+      if (current.ring) current.ring->close();
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        current.ring = std::make_shared<LogRing>(next_thread_++);
+        rings_.push_back(current.ring);
+      }
+      current.logger = id_;
+      startThread();
+    }
+    return current.ring.get();
+  }
+
+  void startThread() {
+    if (!background_) return;
+    std::unique_lock<std::mutex> lock(thread_mutex_);
+    if (thread_ || stop_) return;
+    thread_ = std::make_unique<std::thread>([this]() {
+      std::unique_lock<std::mutex> lock(thread_mutex_);
+      while (!stop_) {
+        wake_.wait_for(lock, std::chrono::milliseconds(10));
+        lock.unlock();
+        flush();
+        lock.lock();
+      }
+    });
+  }
+
+  void stopThread() {
+    std::unique_ptr<std::thread> thread;
+    {
+      std::unique_lock<std::mutex> lock(thread_mutex_);
+      stop_ = true;
+      thread = std::move(thread_);
+    }
+    wake_.notify_all();
+    if (thread) thread->join();
+  }
+
+  static int getDescriptor(FILE* file) {
+#if defined(_WIN32)
+    return _fileno(file);
+#else
+    return fileno(file);
+#endif
+  }
+
+  static int getProcessId() {
+#if defined(_WIN32)
+    return _getpid();
+#else
+    return static_cast<int>(getpid());
+#endif
+  }
+
+#if !defined(_WIN32)
+  // A forked child only has the forking thread. Its drain thread is started again on demand and the
+  // records of the parent are left to the parent.
+  static void registerForkHandlers() {
+    pthread_atfork(
+        []() {
+          get().thread_mutex_.lock();
+          get().mutex_.lock();
+        },
+        []() {
+          get().mutex_.unlock();
+          get().thread_mutex_.unlock();
+        },
+        []() {
+          Logger& logger = get();
+          logger.mutex_.unlock();
+          logger.thread_mutex_.unlock();
+          for (auto& ring : logger.rings_) ring->discard();
+          logger.thread_.release();  // The thread does not exist in the child
+          // The drain thread may have been waiting on wake_, which would never be woken again
+          new (&logger.wake_) std::condition_variable();
+        });
+  }
+#endif
+
+ public:
+  /**
+   * @param level Messages below this level are not recorded.
+   * @param path File the messages are appended to, default_out if empty.
+   * @param background Drain the rings on a background thread, otherwise only flush() drains them.
+   * @param default_out Stream written to when no file is set.
+   */
+  explicit Logger(LogLevel level, const std::string& path = "", bool background = true,
+                  FILE* default_out = stderr)
+      : level_(level),
+        background_(background),
+        default_out_(default_out),
+        out_(default_out),
+        out_fd_(getDescriptor(default_out)) {
+    setOutput(path);
+  }
+
+  ~Logger() {
+    stopThread();
+    flush();
+    if (out_ != default_out_) fclose(out_);
+  }
+
+  Logger(const Logger&) = delete;
+  void operator=(const Logger&) = delete;
+
+  // The logger of the test framework, configured by the environment
+  static Logger& get() {
+    static Logger instance = []() {
+      const char* level = std::getenv("HT_LOG_LEVEL");
+      const char* enable = std::getenv("HT_LOG_ENABLE");
+      const char* file = std::getenv("HT_LOG_FILE");
+      const LogLevel fallback = enable != nullptr ? LogLevel::kDebug : LogLevel::kOff;
+#if !defined(_WIN32)
+      registerForkHandlers();
+#endif
+      return Logger(level != nullptr ? ParseLogLevel(level, fallback) : fallback,
+                    file != nullptr ? file : "", true, stdout);
+    }();
+    return instance;
+  }
+
+  bool enabled(LogLevel level) const {
+    return level != LogLevel::kOff && level >= level_.load(std::memory_order_relaxed);
+  }
+  LogLevel level() const { return level_.load(std::memory_order_relaxed); }
+  void setLevel(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+
+  // Appends to path from now on, to the default stream if empty or if the file can not be opened
+  void setOutput(const std::string& path) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (out_ != default_out_) fclose(out_);
+    out_ = default_out_;
+    if (!path.empty()) {
+      FILE* file = fopen(path.c_str(), "a");
+      if (file != nullptr) {
+        out_ = file;
+      } else {
+        fprintf(stderr, "Unable to open the log file %s\n", path.c_str());
+      }
+    }
+    out_fd_ = getDescriptor(out_);
+  }
+
+  void vlog(LogLevel level, const char* format, va_list args) {
+    if (!enabled(level)) return;
+    LogRing* ring = getRing();
+    LogRecord* record = ring->reserve();
+    if (record == nullptr) return;
+    record->time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start_)
+                       .count();
+    record->thread = ring->thread();
+    record->level = level;
+    va_list copy;
+    va_copy(copy, args);
+    const int length = vsnprintf(record->message, kLogMessageSize, format, args);
+    ring->commit();
+    if (length >= static_cast<int>(kLogMessageSize)) {
+      // The rest of the message continues in the following records, with the same time
+      thread_local std::string message;
+      message.resize(length + 1);
+      vsnprintf(&message[0], message.size(), format, copy);
+      constexpr size_t kChunk = kLogMessageSize - 1;
+      for (size_t offset = kChunk; offset < static_cast<size_t>(length); offset += kChunk) {
+        LogRecord* next = ring->reserve();
+        if (next == nullptr) break;
+        next->time = record->time;
+        next->thread = record->thread;
+        next->level = level;
+        const size_t size = std::min(kChunk, static_cast<size_t>(length) - offset);
+        std::memcpy(next->message, message.data() + offset, size);
+        next->message[size] = '\0';
+        ring->commit();
+      }
+    }
+    va_end(copy);
+    if (level == LogLevel::kError) wake_.notify_one();
+  }
+
+#if defined(__GNUC__) || defined(__clang__)
+  __attribute__((format(printf, 3, 4)))
+#endif
+  void log(LogLevel level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vlog(level, format, args);
+    va_end(args);
+  }
+
+  /**
+   * @brief Writes the recorded messages of all threads in time order. Called periodically by the
+   * drain thread, call it before reading the output.
+   */
+  void flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    write();
+  }
+
+  /**
+   * @brief Flush for a process that is about to die of a fatal signal or std::terminate. Waits at
+   * most 100 ms for a drain in progress instead of blocking, the crashing thread may hold the lock.
+   * Neither allocates nor uses stdio, the crash may have happened inside malloc or printf.
+   */
+  void flushOnCrash() {
+    std::unique_lock<std::mutex> lock(mutex_, std::defer_lock);
+    for (int i = 0; i < 100 && !lock.try_lock(); ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (lock.owns_lock()) writeUnbuffered();
+  }
+
+ private:
+  // Drains the rings into the output, mutex_ is held
+  void write() {
+    pending_.clear();
+    size_t dropped = 0;
+    for (auto& ring : rings_) {
+      ring->drain([this](const LogRecord& record) { pending_.push_back(record); });
+      dropped += ring->takeDropped();
+    }
+    // Rings of exited threads are released once they have been drained
+    rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                [](const auto& ring) { return ring->closed() && ring->empty(); }),
+                 rings_.end());
+    if (pending_.empty() && dropped == 0) return;
+
+    std::stable_sort(pending_.begin(), pending_.end(),
+                     [](const LogRecord& a, const LogRecord& b) { return a.time < b.time; });
+    const int pid = getProcessId();
+    buffer_.clear();
+    for (const auto& record : pending_) {
+      LogLine line;
+      FormatLogRecord(record, pid, line);
+      buffer_.append(line.data(), line.size());
+    }
+    if (dropped != 0) {
+      LogLine line;
+      FormatDroppedLogRecords(dropped, pid, line);
+      buffer_.append(line.data(), line.size());
+    }
+    fwrite(buffer_.data(), 1, buffer_.size(), out_);
+    fflush(out_);
+  }
+
+  // Writes the rings in time order straight to the descriptor of the output, mutex_ is held. The
+  // rings are merged in place, their records are already in time order.
+  void writeUnbuffered() {
+    const int pid = getProcessId();
+    size_t dropped = 0;
+    for (auto& ring : rings_) dropped += ring->takeDropped();
+    for (;;) {
+      LogRing* oldest = nullptr;
+      for (auto& ring : rings_) {
+        const LogRecord* record = ring->front();
+        if (record != nullptr && (oldest == nullptr || record->time < oldest->front()->time)) {
+          oldest = ring.get();
+        }
+      }
+      if (oldest == nullptr) break;
+      LogLine line;
+      FormatLogRecord(*oldest->front(), pid, line);
+      oldest->pop();
+      WriteLogFile(out_fd_, line.data(), line.size());
+    }
+    if (dropped != 0) {
+      LogLine line;
+      FormatDroppedLogRecords(dropped, pid, line);
+      WriteLogFile(out_fd_, line.data(), line.size());
+    }
+  }
+};
+
+// Signal handler that flushes the logger of the test framework and raises the signal again
+inline void FlushLoggerOnSignal(int signal) {
+  Logger::get().flushOnCrash();
+  std::signal(signal, SIG_DFL);
+  std::raise(signal);
+}
+
+// The terminate handler replaced by FlushLoggerOnTerminate
+inline std::terminate_handler& PreviousTerminateHandler() {
+  static std::terminate_handler handler = nullptr;
+  return handler;
+}
+
+inline void FlushLoggerOnTerminate() {
+  Logger::get().flushOnCrash();
+  if (auto previous = PreviousTerminateHandler()) previous();
+  std::abort();
+}
+
+/**
+ * @brief Flushes the logger of the test framework before the process dies of a fatal signal or
+ * of std::terminate, then lets the previous handling kill the process. Catch restores these
+ * handlers and raises the signal again after reporting a fatal condition of a test case.
+ */
+inline void InstallLoggerCrashHandlers() {
+  Logger::get();  // Not constructed for the first time inside a signal handler
+  const auto previous = std::set_terminate(FlushLoggerOnTerminate);
+  if (previous != FlushLoggerOnTerminate) PreviousTerminateHandler() = previous;
+  for (int signal : {SIGABRT, SIGSEGV, SIGFPE, SIGILL, SIGTERM}) {
+    std::signal(signal, FlushLoggerOnSignal);
+  }
+#if !defined(_WIN32)
+  std::signal(SIGBUS, FlushLoggerOnSignal);
+#endif
+}
+
+#define HT_LOG(level, ...)                                                                         \
+  do {                                                                                             \
+    if (Logger::get().enabled(level)) Logger::get().log(level, __VA_ARGS__);                       \
+  } while (0)
+
+#define LogDebug(...) HT_LOG(LogLevel::kDebug, __VA_ARGS__)
+#define LogInfo(...) HT_LOG(LogLevel::kInfo, __VA_ARGS__)
+#define LogWarning(...) HT_LOG(LogLevel::kWarning, __VA_ARGS__)
+#define LogError(...) HT_LOG(LogLevel::kError, __VA_ARGS__)
@@ -0,0 +1,130 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Set of test name patterns compiled into a single trie, where '*' matches any sequence of
+ * characters and every other character matches itself. A name is matched by walking all patterns
+ * of the set at once, so the cost is linear in the length of the name and does not grow with the
+ * number of patterns sharing a prefix.
+ */
+class TestNameMatcher {
+ public:
+  TestNameMatcher() : nodes_(1) {}
+
+  void Add(const std::string& pattern) {
+    size_t node = 0;
+    for (auto c : pattern) {
+      if (c == '*') {
+        if (nodes_[node].any) continue;  // Consecutive wildcards are equivalent to a single one
+        node = GetStar(node);
+      } else {
+        node = GetChild(node, c);
+      }
+    }
+    if (!nodes_[node].accepting) ++size_;
+    nodes_[node].accepting = true;
+  }
+
+  bool Matches(const std::string& name) const {
+    if (size_ == 0) return false;
+
+    std::vector<size_t> active, next;
+    std::vector<size_t> visited(nodes_.size(), 0);
+    size_t step = 1;
+    AddState(0, active, visited, step);
+    for (auto c : name) {
+      ++step;
+      next.clear();
+      for (auto node : active) {
+        if (nodes_[node].any) AddState(node, next, visited, step);
+        const auto child = FindChild(node, c);
+        if (child != kNone) AddState(child, next, visited, step);
+      }
+      if (next.empty()) return false;
+      active.swap(next);
+    }
+
+    for (auto node : active) {
+      if (nodes_[node].accepting) return true;
+    }
+    return false;
+  }
+
+  // Number of distinct patterns in the set
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  static constexpr size_t kNone = static_cast<size_t>(-1);
+
+  struct Node {
+    std::vector<std::pair<char, size_t>> children;
+    size_t star = kNone;     // Node reached through a wildcard
+    bool any = false;        // Node is a wildcard and consumes any character
+    bool accepting = false;  // A pattern ends at this node
+  };
+
+  size_t FindChild(size_t node, char c) const {
+    for (const auto& child : nodes_[node].children) {
+      if (child.first == c) return child.second;
+    }
+    return kNone;
+  }
+
+  size_t GetChild(size_t node, char c) {
+    auto child = FindChild(node, c);
+    if (child != kNone) return child;
+    child = nodes_.size();
+    nodes_.emplace_back();
+    nodes_[node].children.emplace_back(c, child);
+    return child;
+  }
+
+  size_t GetStar(size_t node) {
+    if (nodes_[node].star != kNone) return nodes_[node].star;
+    const auto star = nodes_.size();
+    nodes_.emplace_back();
+    nodes_[star].any = true;
+    nodes_[node].star = star;
+    return star;
+  }
+
+  // Adds a node and, since a wildcard also matches the empty sequence, the wildcard following it
+  void AddState(size_t node, std::vector<size_t>& states, std::vector<size_t>& visited,
+                size_t step) const {
+    while (node != kNone && visited[node] != step) {
+      visited[node] = step;
+      states.push_back(node);
+      node = nodes_[node].star;
+    }
+  }
+
+  std::vector<Node> nodes_;
+  size_t size_ = 0;
+};
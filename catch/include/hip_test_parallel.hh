@@ -0,0 +1,59 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Number of threads used for count work items when threads were requested, 0 requests one
+ * thread per hardware thread.
+ */
+inline size_t GetParallelThreads(size_t count, size_t threads) {
+  if (threads == 0) threads = std::max(std::thread::hardware_concurrency(), 1u);
+  return std::max<size_t>(std::min(threads, count), 1);
+}
+
+/**
+ * @brief Calls work(i) for every i in [0, count) on a bounded pool of threads, the calling thread
+ * being one of them. The items are claimed in increasing order, so the earliest items start first.
+ * work must not throw and must not use the Catch assertion macros, which are not thread safe;
+ * store its results by index instead.
+ *
+ * @param threads Maximum number of threads, 0 for one per hardware thread.
+ */
+template <typename Work> void ParallelFor(size_t count, size_t threads, Work work) {
+  if (count == 0) return;
+  std::atomic<size_t> next{0};
+  auto worker = [&next, count, &work]() {
+    for (size_t i = next++; i < count; i = next++) work(i);
+  };
+
+  std::vector<std::thread> pool;
+  for (size_t i = 1; i < GetParallelThreads(count, threads); ++i) pool.emplace_back(worker);
+  worker();
+  for (auto& thread : pool) thread.join();
+}
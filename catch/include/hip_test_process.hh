@@ -91,6 +91,16 @@ class SpawnProc {
     }
   }
 
+  ~SpawnProc() {
+    if (ret_from_run.valid()) {
+      ret_from_run.wait();
+    }
+    if (captureOutput) {
+      std::error_code error;
+      fs::remove(tmpFileName, error);
+    }
+  }
+
   int run(std::string commandLineArgs = "") {
     std::string execCmd = exeName;
 
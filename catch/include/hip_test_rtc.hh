@@ -25,6 +25,7 @@ THE SOFTWARE.
 #include <hip/hiprtc.h>
 #include <kernel_mapping.hh>
 #include <catch.hpp>
+#include <charconv>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -32,17 +33,22 @@ THE SOFTWARE.
 #include <sstream>
 #include <set>
 #include <mutex>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <utility>
 #include "hip/hip_runtime_api.h"
 #include "hip_test_context.hh"
+#include "hip_test_filesystem.hh"
+#include "hip_test_kernel_arguments.hh"
+#include "hip_test_parallel.hh"
+#include "hip_test_rtc_cache.hh"
+#if defined(HT_EMBEDDED_KERNELS)
+#include "hip_test_embedded_kernels.hh"
+#endif
 
 namespace HipTest {
 
-struct KernelArgument {
-  const void* ptr;
-  size_t sizeRequirement;
-  size_t alignmentRequirement;
-};
-
 /**
  * @brief Reconstructs the name expression for the kernel.
  *
@@ -66,52 +72,31 @@ inline std::string reconstructExpression(std::string& kernelName,
 }
 
 /**
- * @brief Packs the kernel arguments into the format expected by hipModuleLaunchKernel
+ * @brief Get the source of a kernel file, without the include directives which are not part of
+ * the kernel. The sources embedded at build time are used if available, otherwise the file is read
+ * from the kernels folder.
  *
- * @param args list of arguments for the kernel and their alignemnt requirements.
- * @return std::vector<char> the packed arguments ready to be passed on to hipModuleLaunchKernel
+ * @param fileName the name of the file in the kernels folder.
+ * @param source the source of the kernel.
+ * @param hash the content hash of the source if it is embedded, empty otherwise.
+ * @return false if the file can not be opened.
  */
-inline std::vector<char> alignArguments(std::vector<KernelArgument>& args) {
-  std::vector<char> alignedArguments{};
-  int count = 0;
-  for (auto& arg : args) {
-    const char* argPtr{reinterpret_cast<const char*>(arg.ptr)};
-
-    int paddingNeeded = (arg.alignmentRequirement - 1) & (~count + 1);
-    alignedArguments.insert(std::end(alignedArguments), paddingNeeded, 0);
-    count += paddingNeeded;
-
-    alignedArguments.insert(std::end(alignedArguments), argPtr, argPtr + arg.sizeRequirement);
-    count += arg.sizeRequirement;
+inline bool readKernelSource(const std::string& fileName, std::string& source,
+                             std::string& hash) {
+#if defined(HT_EMBEDDED_KERNELS)
+  for (auto kernel = kEmbeddedKernels; kernel->file != nullptr; ++kernel) {
+    if (fileName == kernel->file) {
+      source = kernel->source;
+      hash = kernel->hash;
+      return true;
+    }
+  }
+#endif
+  hash.clear();
+  std::ifstream kernelFile{KERNELS_PATH + fileName};
+  if (!kernelFile.is_open()) {
+    return false;
   }
-  return alignedArguments;
-}
-
-inline std::vector<char> getKernelCode(hiprtcProgram& rtcProgram) {
-  size_t codeSize;
-  REQUIRE(HIPRTC_SUCCESS == hiprtcGetCodeSize(rtcProgram, &codeSize));
-
-  std::vector<char> code(codeSize);
-  REQUIRE(HIPRTC_SUCCESS == hiprtcGetCode(rtcProgram, code.data()));
-
-  return code;
-}
-
-/**
- * @brief Compiles a kernel using HIP RTC
- *
- * @param rtcKernel the name of the kernel to compile.
- * @param kernelNameExpression the name expression to be added to the RTC program (e.g.
- * HipTest::VectorADD<float>)
- * @return hiprtcProgram the compiled rtc program.
- */
-inline hiprtcProgram compileRTC(std::string& rtcKernel, std::string& kernelNameExpression) {
-  std::string fileName = mapKernelToFileName.at(rtcKernel);
-  std::string filePath{KERNELS_PATH + fileName};
-
-  INFO("Opening Kernel File: " << filePath);
-  std::ifstream kernelFile{filePath};
-  REQUIRE(kernelFile.is_open());
 
   std::stringstream stringStream;
   std::string line;
@@ -124,37 +109,333 @@ inline hiprtcProgram compileRTC(std::string& rtcKernel, std::string& kernelNameE
   }
   kernelFile.close();
 
-  std::string kernelCode{stringStream.str()};
-  INFO("RTC Kernel Code:\n" << kernelCode)
+  source = stringStream.str();
+  return true;
+}
 
-  hiprtcProgram rtcProgram;
-  hiprtcCreateProgram(&rtcProgram, kernelCode.c_str(), (fileName + ".cu").c_str(), 0, nullptr,
-                      nullptr);
+inline std::string getKernelSource(const std::string& fileName, std::string& hash) {
+  std::string source;
+  INFO("Opening Kernel File: " << KERNELS_PATH << fileName);
+  REQUIRE(readKernelSource(fileName, source, hash));
+  return source;
+}
 
-  std::vector<const char*> options{};
+/**
+ * @brief Get the architectures of all devices, which the kernels are compiled for.
+ *
+ * @param architectures the sorted, unique architecture names. Empty on NVIDIA, where the default
+ * architecture is used.
+ * @return false if the devices can not be queried.
+ */
+inline bool queryTargetArchitectures(std::vector<std::string>& architectures) {
+  std::set<std::string> names{};
 #ifdef __HIP_PLATFORM_AMD__
-
   int deviceCount;
-  REQUIRE(hipSuccess == hipGetDeviceCount(&deviceCount));
+  if (hipGetDeviceCount(&deviceCount) != hipSuccess) {
+    return false;
+  }
 
-  std::set<std::string> architectures{};
   for (int i = 0; i < deviceCount; ++i) {
     hipDeviceProp_t props;
-    REQUIRE(hipSuccess == hipGetDeviceProperties(&props, i));
-    architectures.insert(std::string{"--gpu-architecture="} + props.gcnArchName);
+    if (hipGetDeviceProperties(&props, i) != hipSuccess) {
+      return false;
+    }
+    names.insert(props.gcnArchName);
   }
+#endif
+  architectures.assign(names.begin(), names.end());
+  return true;
+}
+
+inline std::vector<std::string> getTargetArchitectures() {
+  std::vector<std::string> architectures;
+  REQUIRE(queryTargetArchitectures(architectures));
+  return architectures;
+}
 
+inline std::vector<std::string> getCompileOptions(const std::vector<std::string>& architectures) {
+  std::vector<std::string> options{};
+#ifdef __HIP_PLATFORM_AMD__
   for (auto& architecture : architectures) {
-    options.push_back(architecture.c_str());
+    options.push_back(std::string{"--gpu-architecture="} + architecture);
   }
 #else
   options.push_back("--fmad=false");
 #endif
+  return options;
+}
 
-  REQUIRE(HIPRTC_SUCCESS == hiprtcAddNameExpression(rtcProgram, kernelNameExpression.c_str()));
-  REQUIRE(HIPRTC_SUCCESS == hiprtcCompileProgram(rtcProgram, 1, options.data()));
+/**
+ * @brief Identity of the HIP RTC library and the runtime loaded by the process. The compiled code
+ * depends on them rather than on the headers the tests were built with.
+ */
+inline const std::string& getRtcCompilerVersion() {
+  static const std::string version = []() {
+    int major = 0, minor = 0, runtime = 0;
+    static_cast<void>(hiprtcVersion(&major, &minor));
+    static_cast<void>(hipRuntimeGetVersion(&runtime));
+    return "hiprtc " + std::to_string(major) + "." + std::to_string(minor) + ", runtime " +
+        std::to_string(runtime);
+  }();
+  return version;
+}
 
-  return rtcProgram;
+/**
+ * @brief Get the key of a kernel in the disk cache, which covers everything the compilation
+ * depends on.
+ */
+inline RtcCacheKey getKernelCacheKey(const std::string& source, const std::string& sourceHash,
+                                     const std::string& kernelNameExpression,
+                                     const std::vector<std::string>& architectures) {
+  RtcCacheKey key;
+  key.source = source;
+  key.source_hash = sourceHash;
+  key.expression = kernelNameExpression;
+  key.architectures = architectures;
+  key.options = getCompileOptions(architectures);
+  key.compiler = getRtcCompilerVersion();
+  return key;
+}
+
+/**
+ * @brief Compiles a kernel using HIP RTC. Does not use the Catch macros, so that kernels can be
+ * compiled on several threads.
+ *
+ * @param fileName the name of the kernel file, used to name the program.
+ * @param key the source, name expression (e.g. HipTest::VectorADD<float>) and options to compile.
+ * @param entry the code object and the lowered name of the name expression.
+ * @param error the failed call and the compile log, if the compilation failed.
+ * @return false if the compilation failed.
+ */
+inline bool compileRTC(const std::string& fileName, const RtcCacheKey& key, RtcCacheEntry& entry,
+                       std::string& error) {
+  hiprtcProgram rtcProgram;
+  if (hiprtcCreateProgram(&rtcProgram, key.source.c_str(), (fileName + ".cu").c_str(), 0, nullptr,
+                          nullptr) != HIPRTC_SUCCESS) {
+    error = "hiprtcCreateProgram failed";
+    return false;
+  }
+
+  std::vector<const char*> options{};
+  for (auto& option : key.options) {
+    options.push_back(option.c_str());
+  }
+
+  const char* loweredName = nullptr;
+  size_t codeSize = 0;
+  if (hiprtcAddNameExpression(rtcProgram, key.expression.c_str()) != HIPRTC_SUCCESS) {
+    error = "hiprtcAddNameExpression failed";
+  } else if (hiprtcCompileProgram(rtcProgram, options.size(), options.data()) != HIPRTC_SUCCESS) {
+    error = "hiprtcCompileProgram failed";
+    size_t logSize = 0;
+    if (hiprtcGetProgramLogSize(rtcProgram, &logSize) == HIPRTC_SUCCESS && logSize > 1) {
+      std::string log(logSize, '\0');
+      if (hiprtcGetProgramLog(rtcProgram, &log[0]) == HIPRTC_SUCCESS) {
+        error += ":\n" + std::string(log.c_str());
+      }
+    }
+  } else if (hiprtcGetCodeSize(rtcProgram, &codeSize) != HIPRTC_SUCCESS || codeSize == 0) {
+    error = "hiprtcGetCodeSize failed";
+  } else {
+    entry.code.resize(codeSize);
+    if (hiprtcGetCode(rtcProgram, entry.code.data()) != HIPRTC_SUCCESS) {
+      error = "hiprtcGetCode failed";
+    } else if (hiprtcGetLoweredName(rtcProgram, key.expression.c_str(), &loweredName) !=
+               HIPRTC_SUCCESS) {
+      error = "hiprtcGetLoweredName failed";
+    } else {
+      entry.lowered_name = loweredName;
+    }
+  }
+
+  /* After obtaining the code and the lowered name, the program is no longer needed */
+  hiprtcDestroyProgram(&rtcProgram);
+  return error.empty();
+}
+
+/**
+ * @brief The disk cache of the compiled kernels, shared by all test processes of the user.
+ * Configured with HIP_RTC_CACHE_DIR (default: GetRtcCacheDefaultDir) and HIP_RTC_CACHE_SIZE in
+ * MiB (default: 1024, 0 disables the cache).
+ */
+inline RtcCodeObjectCache& getRtcCache() {
+  static RtcCodeObjectCache cache = []() {
+    std::string dir = TestContext::getEnvVar("HIP_RTC_CACHE_DIR");
+    if (dir.empty()) dir = GetRtcCacheDefaultDir();
+    const std::string size = TestContext::getEnvVar("HIP_RTC_CACHE_SIZE");
+    uint64_t maxSize = kRtcCacheDefaultSize;
+    if (!size.empty()) {
+      uint64_t mebibytes = 0;
+      const auto end = size.data() + size.size();
+      const auto result = std::from_chars(size.data(), end, mebibytes);
+      if (result.ec == std::errc() && result.ptr == end && mebibytes <= (UINT64_MAX >> 20)) {
+        maxSize = mebibytes << 20;
+      } else {
+        std::cerr << "Invalid HIP_RTC_CACHE_SIZE " << size << ", using "
+                  << (kRtcCacheDefaultSize >> 20) << " MiB" << std::endl;
+      }
+    }
+    RtcCodeObjectCache cache(dir, maxSize);
+    if (cache.rejected()) {
+      std::cerr << "The RTC cache directory " << dir
+                << " is not owned by the current user or is writable by others, the cache is "
+                   "disabled"
+                << std::endl;
+    }
+    return cache;
+  }();
+  return cache;
+}
+
+/**
+ * @brief Get the code object of a kernel from the disk cache, or compile it with HIP RTC and store
+ * it in the cache. Thread safe and does not use the Catch macros.
+ *
+ * @param cached set if the code object was found in the cache.
+ * @return false with the reason in error if the kernel could not be compiled.
+ */
+inline bool loadOrCompileKernel(const std::string& fileName, const RtcCacheKey& key,
+                                RtcCacheEntry& entry, bool& cached, std::string& error) {
+  RtcCodeObjectCache& cache = getRtcCache();
+  const std::string digest = GetRtcCacheDigest(key);
+  cached = cache.load(digest, entry);
+  if (cached) {
+    return true;
+  }
+  if (!compileRTC(fileName, key, entry, error)) {
+    return false;
+  }
+  cache.store(digest, entry);
+  return true;
+}
+
+/**
+ * @brief Get the code object of a kernel, from the disk cache or by compiling it with HIP RTC.
+ *
+ * @param rtcKernel the name of the kernel to compile.
+ * @param kernelNameExpression the name expression of the kernel (e.g. HipTest::VectorADD<float>)
+ * @return RtcCacheEntry the code object and the lowered name of the name expression.
+ */
+inline RtcCacheEntry getKernelCodeObject(const std::string& rtcKernel,
+                                         const std::string& kernelNameExpression) {
+  const std::string fileName = mapKernelToFileName.at(rtcKernel);
+  std::string sourceHash;
+  const std::string source{getKernelSource(fileName, sourceHash)};
+  const RtcCacheKey key{
+      getKernelCacheKey(source, sourceHash, kernelNameExpression, getTargetArchitectures())};
+
+  RtcCacheEntry entry;
+  bool cached;
+  std::string error;
+  const bool compiled = loadOrCompileKernel(fileName, key, entry, cached, error);
+  INFO("RTC Kernel Code:\n" << key.source << "\n" << error);
+  REQUIRE(compiled);
+  return entry;
+}
+
+/**
+ * @brief Result of the ahead of time compilation of a kernel instantiation.
+ */
+struct RtcPrecompileResult {
+  std::string expression;  // Name expression
+  double time = 0;         // Seconds spent to compile or to read the disk cache
+  bool cached = false;     // Found in the disk cache
+  bool loaded = false;     // Loaded, so that its launches do not compile or read the disk cache
+  std::string error;
+};
+
+/**
+ * @brief Compiles all kernel instantiations of mapKernelToInstantiations concurrently and loads
+ * them, so that the tests do not stall on compilation when they launch the kernels. Kernels that
+ * fail here are compiled, and reported, by their first launch.
+ *
+ * @param threads Maximum number of compiling threads, 0 for one per hardware thread.
+ * @param load Load the modules into this process. Otherwise the code objects are only stored in
+ * the disk cache, for the test processes started afterwards.
+ */
+inline std::vector<RtcPrecompileResult> precompileRTCKernels(size_t threads, bool load = true) {
+  std::vector<std::pair<std::string, std::string>> kernels{};  // File and name expression
+  for (auto& kernel : mapKernelToInstantiations) {
+    for (auto& expression : kernel.second) {
+      kernels.emplace_back(mapKernelToFileName.at(kernel.first), expression);
+    }
+  }
+
+  std::vector<RtcPrecompileResult> results(kernels.size());
+  std::vector<RtcCacheEntry> entries(kernels.size());
+  std::vector<std::string> architectures;
+  const bool devices = queryTargetArchitectures(architectures);
+
+  ParallelFor(kernels.size(), threads, [&](size_t i) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::string& fileName = kernels[i].first;
+    RtcPrecompileResult& result = results[i];
+    result.expression = kernels[i].second;
+
+    std::string source, sourceHash;
+    if (!devices) {
+      result.error = "Unable to query the devices";
+    } else if (!readKernelSource(fileName, source, sourceHash)) {
+      result.error = "Unable to open the kernel file " + fileName;
+    } else {
+      loadOrCompileKernel(fileName,
+                          getKernelCacheKey(source, sourceHash, result.expression, architectures),
+                          entries[i], result.cached, result.error);
+    }
+    result.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  });
+  if (!load) {
+    return results;
+  }
+
+  /* The modules are loaded on this thread, the state of the test context is not thread safe */
+  TestContext& testContext = TestContext::get();
+  for (size_t i = 0; i < results.size(); ++i) {
+    RtcPrecompileResult& result = results[i];
+    if (!result.error.empty() || testContext.getFunction(result.expression) != nullptr) {
+      continue;
+    }
+    hipModule_t module;
+    hipFunction_t kernelFunction;
+    if (hipModuleLoadData(&module, entries[i].code.data()) != hipSuccess) {
+      result.error = "hipModuleLoadData failed";
+      continue;
+    }
+    if (hipModuleGetFunction(&kernelFunction, module, entries[i].lowered_name.c_str()) !=
+        hipSuccess) {
+      result.error = "hipModuleGetFunction failed";
+      hipModuleUnload(module);
+      continue;
+    }
+    testContext.trackRtcState(result.expression, module, kernelFunction);
+    result.loaded = true;
+  }
+  return results;
+}
+
+/**
+ * @brief Prints the compile time of every kernel instantiation, slowest first.
+ *
+ * @param time Wall time of the whole precompilation in seconds.
+ */
+inline void printPrecompileReport(std::ostream& out, std::vector<RtcPrecompileResult> results,
+                                  double time, size_t threads) {
+  std::stable_sort(results.begin(), results.end(),
+                   [](const auto& a, const auto& b) { return a.time > b.time; });
+  const size_t failed = std::count_if(results.begin(), results.end(),
+                                      [](const auto& result) { return !result.error.empty(); });
+  out << "RTC precompile: " << results.size() << " kernels on " << threads << " threads in "
+      << std::fixed << std::setprecision(3) << time << " s, " << failed << " failed" << std::endl;
+  for (const auto& result : results) {
+    out << std::setw(10) << result.time * 1000 << " ms  " << result.expression;
+    if (!result.error.empty()) {
+      out << " [failed] " << result.error;
+    } else if (result.cached) {
+      out << " [cached]";
+    }
+    out << std::endl;
+  }
+  out << std::defaultfloat;
 }
 
 /**
@@ -198,6 +479,59 @@ static inline void printInfo() {
   }
 }
 
+/**
+ * @brief Returns the function of a kernel instantiation, compiling and loading it on first use.
+ *
+ * The function is cached per thread and per template instantiation, so that launching a kernel
+ * again neither builds its name expression nor locks the test context. Cached functions are
+ * dropped when TestContext::cleanContext unloads the modules.
+ *
+ * @tparam Typenames A list of typenames used by the kernel (unused if the kernel is not a
+ * template).
+ * @param getKernelName A function wrapper that returns the name of the kernel.
+ */
+template <typename... Typenames>
+hipFunction_t getRTCKernelFunction(std::string (*getKernelName)()) {
+  struct CachedFunction {
+    std::string (*getKernelName)();
+    hipFunction_t function;
+  };
+  static thread_local std::vector<CachedFunction> cachedFunctions;
+  static thread_local uint64_t cachedGeneration = 0;
+
+  TestContext& testContext = TestContext::get();
+  const uint64_t generation = testContext.getRtcGeneration();
+  if (generation != cachedGeneration) {
+    cachedFunctions.clear();
+    cachedGeneration = generation;
+  }
+  for (const auto& cached : cachedFunctions) {
+    if (cached.getKernelName == getKernelName) return cached.function;
+  }
+
+  std::string kernelName = (*getKernelName)();
+  std::vector<std::string> kernelTypenames{std::string(HipTest::getTypeName<Typenames>())...};
+  std::string kernelExpression = reconstructExpression(kernelName, kernelTypenames);
+
+  static std::mutex mutex{};
+  std::lock_guard<std::mutex> lockGuard(mutex);
+  hipFunction_t kernelFunction = testContext.getFunction(kernelExpression);
+  if (kernelFunction == nullptr) {
+    RtcCacheEntry codeObject{getKernelCodeObject(kernelName, kernelExpression)};
+
+    hipModule_t module;
+
+    REQUIRE(hipSuccess == hipModuleLoadData(&module, codeObject.code.data()));
+
+    REQUIRE(hipSuccess ==
+            hipModuleGetFunction(&kernelFunction, module, codeObject.lowered_name.c_str()));
+
+    testContext.trackRtcState(kernelExpression, module, kernelFunction);
+  }
+  cachedFunctions.push_back({getKernelName, kernelFunction});
+  return kernelFunction;
+}
+
 /**
  * @brief Compiles and launches a kernel using HIP RTC
  *
@@ -216,48 +550,11 @@ template <typename... Typenames, typename... Args>
 void launchRTCKernel(std::string (*getKernelName)(), dim3 numBlocks, dim3 numThreads,
                      std::uint32_t memPerBlock, hipStream_t stream, Args&&... packedArgs) {
   printInfo();
-  TestContext& testContext = TestContext::get();
-  std::string kernelName = (*getKernelName)();
-
-  std::vector<std::string> kernelTypenames{std::string(HipTest::getTypeName<Typenames>())...};
-  std::string kernelExpression = reconstructExpression(kernelName, kernelTypenames);
-
-  static std::mutex mutex{};
-  {
-    std::lock_guard<std::mutex> lockGuard(mutex);
-    if (testContext.getFunction(kernelExpression) == nullptr) {
-      hiprtcProgram rtcProgram{compileRTC(kernelName, kernelExpression)};
-      std::vector<char> compiledCode{getKernelCode(rtcProgram)};
-
-      hipModule_t module;
-
-      REQUIRE(hipSuccess == hipModuleLoadData(&module, compiledCode.data()));
-
-      hipFunction_t kernelFunction;
-
-      const char* loweredName;
-      REQUIRE(HIPRTC_SUCCESS ==
-              hiprtcGetLoweredName(rtcProgram, kernelExpression.c_str(), &loweredName));
-      REQUIRE(hipSuccess == hipModuleGetFunction(&kernelFunction, module, loweredName));
-
-      /* After obtaining the kernelFunction, the program is no longer needed. So it can be destroyed */
-      REQUIRE(HIPRTC_SUCCESS == hiprtcDestroyProgram(&rtcProgram));
-
-      testContext.trackRtcState(kernelExpression, module, kernelFunction);
-    }
-  }
-
-  hipFunction_t kernelFunction = testContext.getFunction(kernelExpression);
-
-  std::vector<KernelArgument> args = {
-      {reinterpret_cast<const void*>(&packedArgs), sizeof(Args), alignof(Args)}...};
-
-  std::vector<char> alignedArguments{alignArguments(args)};
-  size_t argumentsSize{alignedArguments.size()};
+  hipFunction_t kernelFunction = getRTCKernelFunction<Typenames...>(getKernelName);
 
-  void* config_array[] = {HIP_LAUNCH_PARAM_BUFFER_POINTER, alignedArguments.data(),
-                          HIP_LAUNCH_PARAM_BUFFER_SIZE, reinterpret_cast<void*>(&argumentsSize),
-                          HIP_LAUNCH_PARAM_END};
+  PackedKernelArguments<Args...> arguments{packedArgs...};
+  void* config_array[] = {HIP_LAUNCH_PARAM_BUFFER_POINTER, arguments.data(),
+                          HIP_LAUNCH_PARAM_BUFFER_SIZE, arguments.size(), HIP_LAUNCH_PARAM_END};
 
   REQUIRE(hipSuccess ==
           hipModuleLaunchKernel(kernelFunction, numBlocks.x, numBlocks.y, numBlocks.z, numThreads.x,
@@ -0,0 +1,298 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "hip_test_filesystem.hh"
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Host only, content addressed disk cache of the code objects compiled by HIP RTC. An entry is
+ * keyed by a hash of everything the compilation depends on, so that processes compiling the same
+ * kernel share the entry and entries never have to be invalidated. Entries are written to a
+ * temporary file that is renamed into place, so that concurrent processes only ever see complete
+ * entries. When the cache grows beyond its size limit, the least recently used entries are
+ * removed. The tests load and run the code objects of the cache, so a directory that other users
+ * can write to is not used.
+ */
+
+// Incremented whenever the format of the entries or of the key changes
+constexpr int kRtcCacheVersion = 1;
+constexpr uint64_t kRtcCacheDefaultSize = 1024ull << 20;  // bytes
+
+struct RtcCacheKey {
+  std::string source;       // Kernel source, as passed to hiprtcCreateProgram
+  std::string source_hash;  // Content hash of the source if known, digested instead of it
+  std::string expression;   // Name expression, e.g. HipTest::vectorADD<float>
+  std::vector<std::string> options;
+  std::vector<std::string> architectures;
+  std::string compiler;  // Versions of the HIP RTC library and runtime that compile the source
+};
+
+inline uint64_t GetRtcCacheHash(const std::string& data, uint64_t hash) {
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/**
+ * @brief 128 bit hex digest of a key, two FNV-1a hashes with different offsets. Every field is
+ * prefixed with its length, so that fields can not run into each other.
+ */
+inline std::string GetRtcCacheDigest(const RtcCacheKey& key) {
+  std::string data = std::to_string(kRtcCacheVersion) + ';';
+  auto add = [&data](const std::string& field) {
+    data += std::to_string(field.size()) + ':' + field + ';';
+  };
+  add(key.source_hash.empty() ? key.source : "#" + key.source_hash);
+  add(key.expression);
+  add(std::to_string(key.options.size()));
+  for (const auto& option : key.options) add(option);
+  add(std::to_string(key.architectures.size()));
+  for (const auto& architecture : key.architectures) add(architecture);
+  add(key.compiler);
+
+  char digest[33];
+  snprintf(digest, sizeof(digest), "%016llx%016llx",
+           static_cast<unsigned long long>(GetRtcCacheHash(data, 14695981039346656037ull)),
+           static_cast<unsigned long long>(GetRtcCacheHash(data, 7809847782465536322ull)));
+  return digest;
+}
+
+struct RtcCacheEntry {
+  std::vector<char> code;   // Code object
+  std::string lowered_name;  // Lowered name of the name expression
+};
+
+/**
+ * @brief Cache directory of the current user: hip-tests-rtc in XDG_CACHE_HOME or ~/.cache, or
+ * hip-tests-rtc-cache-<uid> in the temporary directory without a home directory. The temporary
+ * directory of Windows is already per user. Empty if no directory can be determined.
+ */
+inline std::string GetRtcCacheDefaultDir() {
+#if !defined(_WIN32)
+  const char* cache = std::getenv("XDG_CACHE_HOME");
+  if (cache != nullptr && cache[0] == '/') return (fs::path(cache) / "hip-tests-rtc").string();
+  const char* home = std::getenv("HOME");
+  if (home != nullptr && home[0] == '/') {
+    return (fs::path(home) / ".cache" / "hip-tests-rtc").string();
+  }
+#endif
+  std::error_code error;
+  const fs::path temp = fs::temp_directory_path(error);
+  if (error) return "";
+#if defined(_WIN32)
+  return (temp / "hip-tests-rtc-cache").string();
+#else
+  return (temp / ("hip-tests-rtc-cache-" + std::to_string(geteuid()))).string();
+#endif
+}
+
+/**
+ * @brief Whether dir is a directory owned by the current user that other users can not write to.
+ * Always true on Windows, where the ACLs of the user profile protect the default directory.
+ */
+inline bool IsRtcCacheDirTrusted(const fs::path& dir) {
+#if defined(_WIN32)
+  std::error_code error;
+  return fs::is_directory(dir, error);
+#else
+  struct stat info;
+  if (stat(dir.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) return false;
+  return info.st_uid == geteuid() && (info.st_mode & S_IWOTH) == 0;
+#endif
+}
+
+class RtcCodeObjectCache {
+  fs::path dir_;
+  uint64_t max_size_;
+  bool rejected_ = false;
+
+  static constexpr const char* kExtension = ".hipco";
+
+  // "HTRTC<version>\n<lowered name>\n<code object>"
+  static std::string GetMagic() { return "HTRTC" + std::to_string(kRtcCacheVersion); }
+
+ public:
+  /**
+   * @param dir Directory of the entries, created accessible only by the current user if it does
+   * not exist. The cache is disabled if the directory is not trusted, see IsRtcCacheDirTrusted.
+   * @param max_size Size limit of all entries in bytes, 0 disables the cache.
+   */
+  RtcCodeObjectCache(const std::string& dir, uint64_t max_size = kRtcCacheDefaultSize)
+      : dir_(dir), max_size_(max_size) {
+    if (!enabled()) return;
+    std::error_code error;
+    if (fs::create_directories(dir_, error)) {
+      fs::permissions(dir_, fs::perms::owner_all, error);
+    }
+    if (!IsRtcCacheDirTrusted(dir_)) {
+      rejected_ = true;
+      dir_.clear();
+    }
+  }
+
+  bool enabled() const { return max_size_ > 0 && !dir_.empty(); }
+  // The directory was not used because other users can write to it
+  bool rejected() const { return rejected_; }
+  const fs::path& dir() const { return dir_; }
+  fs::path getPath(const std::string& digest) const { return dir_ / (digest + kExtension); }
+
+  /**
+   * @brief Reads the entry of digest. A hit marks the entry as recently used.
+   *
+   * @return false if there is no valid entry.
+   */
+  bool load(const std::string& digest, RtcCacheEntry& entry) const {
+    if (!enabled()) return false;
+    const fs::path path = getPath(digest);
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    std::string magic;
+    if (!std::getline(in, magic) || magic != GetMagic()) return false;
+    if (!std::getline(in, entry.lowered_name) || entry.lowered_name.empty()) return false;
+    entry.code.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (entry.code.empty()) return false;
+    in.close();
+
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+    return true;
+  }
+
+  /**
+   * @brief Writes the entry of digest, replacing an existing one atomically, then evicts the least
+   * recently used entries if the cache grew beyond its size limit.
+   */
+  bool store(const std::string& digest, const RtcCacheEntry& entry) const {
+    if (!enabled() || entry.code.empty() || entry.lowered_name.empty()) return false;
+
+    // Unique within the machine, the cache directory may be shared by several processes
+    static std::atomic<uint64_t> counter{0};
+#if defined(_WIN32)
+    const int pid = _getpid();
+#else
+    const int pid = static_cast<int>(getpid());
+#endif
+    std::stringstream temp_name;
+    temp_name << digest << ".tmp." << pid << '.' << std::this_thread::get_id() << '.'
+              << std::chrono::steady_clock::now().time_since_epoch().count() << '.' << counter++;
+    const fs::path temp = dir_ / temp_name.str();
+    {
+      std::ofstream out(temp, std::ios::binary);
+      out << GetMagic() << '\n' << entry.lowered_name << '\n';
+      out.write(entry.code.data(), entry.code.size());
+      out.close();
+      if (!out) {
+        std::error_code error;
+        fs::remove(temp, error);
+        return false;
+      }
+    }
+    std::error_code error;
+    fs::rename(temp, getPath(digest), error);
+    if (error) {
+      fs::remove(temp, error);
+      return false;
+    }
+    evict();
+    return true;
+  }
+
+  // Total size of the entries in bytes
+  uint64_t size() const {
+    uint64_t total = 0;
+    std::error_code error;
+    for (fs::directory_iterator it(dir_, error), end; !error && it != end; it.increment(error)) {
+      if (it->path().extension() != kExtension) continue;
+      std::error_code size_error;
+      const auto size = fs::file_size(it->path(), size_error);
+      if (!size_error) total += size;
+    }
+    return total;
+  }
+
+  /**
+   * @brief Removes the least recently used entries until the cache fits its size limit. Entries
+   * removed concurrently by other processes are skipped.
+   */
+  void evict() const {
+    struct File {
+      fs::path path;
+      fs::file_time_type time;
+      uint64_t size;
+    };
+    std::vector<File> files;
+    uint64_t total = 0;
+    std::error_code error;
+    const auto stale = fs::file_time_type::clock::now() - std::chrono::hours(1);
+    for (fs::directory_iterator it(dir_, error), end; !error && it != end; it.increment(error)) {
+      std::error_code file_error;
+      if (it->path().extension() != kExtension) {
+        // Temporary files left behind by processes that died while storing an entry
+        const bool temporary = it->path().filename().string().find(".tmp.") != std::string::npos;
+        if (temporary && fs::last_write_time(it->path(), file_error) < stale && !file_error) {
+          fs::remove(it->path(), file_error);
+        }
+        continue;
+      }
+      File file{it->path(), fs::last_write_time(it->path(), file_error), 0};
+      file.size = fs::file_size(it->path(), file_error);
+      if (file_error) continue;
+      total += file.size;
+      files.push_back(file);
+    }
+    if (total <= max_size_) return;
+
+    std::sort(files.begin(), files.end(),
+              [](const File& a, const File& b) { return a.time < b.time; });
+    for (const auto& file : files) {
+      if (total <= max_size_) break;
+      std::error_code remove_error;
+      fs::remove(file.path, remove_error);
+      total -= file.size;
+    }
+  }
+};
@@ -0,0 +1,199 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "hip_test_batch.hh"
+
+/**
+ * Host only timings of test cases and the duration aware partitioning of test cases into shards.
+ * The timings file is a log with a tab separated line per run test case,
+ * "name<TAB>seconds<TAB>setup seconds<TAB>result", so that several test processes can append to it
+ * at the same time. The latest line of a test case wins.
+ */
+
+struct TestTiming {
+  double time = 0;     // Wall time in seconds
+  double setup = 0;    // Seconds the process spent before the test case, since it started or
+                       // since the previous test case ended
+  std::string result;  // passed, failed or skipped
+};
+
+using TestTimings = std::unordered_map<std::string, TestTiming>;
+
+inline TestTimings ReadTestTimings(const std::string& path) {
+  TestTimings timings;
+  std::ifstream in(path);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::vector<std::string> fields;
+    std::stringstream record(line);
+    std::string field;
+    while (std::getline(record, field, '\t')) fields.push_back(field);
+    if (fields.size() < 2) continue;
+    auto& timing = timings[UnescapeBatchField(fields[0])];
+    timing.time = std::atof(fields[1].c_str());
+    timing.setup = fields.size() > 2 ? std::atof(fields[2].c_str()) : 0;
+    timing.result = fields.size() > 3 ? fields[3] : "";
+  }
+  return timings;
+}
+
+/**
+ * @brief Appends the timing of a test case to the timings file. The line is written at once, so
+ * that lines of processes appending concurrently do not interleave.
+ */
+inline bool AppendTestTiming(const std::string& path, const std::string& name,
+                             const TestTiming& timing) {
+  std::stringstream line;
+  line << std::fixed << std::setprecision(6) << EscapeBatchField(name) << '\t' << timing.time
+       << '\t' << timing.setup << '\t' << timing.result << '\n';
+  std::ofstream out(path, std::ios::app);
+  out << line.str();
+  out.close();
+  return static_cast<bool>(out);
+}
+
+/**
+ * @brief Expected durations of test cases for partitioning. Test cases without a timing are
+ * expected to take the median of the known durations, or one second if none are known.
+ */
+inline std::vector<double> EstimateDurations(const std::vector<std::string>& tests,
+                                             const TestTimings& timings) {
+  std::vector<double> known;
+  for (const auto& test : tests) {
+    auto it = timings.find(test);
+    if (it != timings.end()) known.push_back(it->second.time);
+  }
+  double fallback = 1;
+  if (!known.empty()) {
+    std::sort(known.begin(), known.end());
+    fallback = known[known.size() / 2];
+  }
+
+  std::vector<double> durations;
+  durations.reserve(tests.size());
+  for (const auto& test : tests) {
+    auto it = timings.find(test);
+    durations.push_back(it != timings.end() ? it->second.time : fallback);
+  }
+  return durations;
+}
+
+/**
+ * @brief Partitions test cases into shards of similar total duration with the longest processing
+ * time first rule: in order of decreasing duration, every test case is assigned to the shard with
+ * the smallest total so far. Ties are broken by name and by shard index, so that every machine
+ * computes the same partition.
+ *
+ * @param durations Expected duration of every test case.
+ * @return the test cases of every shard, each in the order of tests.
+ */
+inline std::vector<std::vector<std::string>> PartitionTests(const std::vector<std::string>& tests,
+                                                            const std::vector<double>& durations,
+                                                            size_t count) {
+  std::vector<std::vector<std::string>> shards(count);
+  if (count == 0) return shards;
+
+  std::vector<size_t> order(tests.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if (durations[a] != durations[b]) return durations[a] > durations[b];
+    return tests[a] < tests[b];
+  });
+
+  std::vector<double> loads(count, 0);
+  std::vector<size_t> assignment(tests.size());
+  for (auto i : order) {
+    const auto shard = std::min_element(loads.begin(), loads.end()) - loads.begin();
+    loads[shard] += durations[i];
+    assignment[i] = shard;
+  }
+  for (size_t i = 0; i < tests.size(); ++i) shards[assignment[i]].push_back(tests[i]);
+  return shards;
+}
+
+// FNV-1a, stable across platforms and standard libraries unlike std::hash
+inline uint64_t GetStableHash(const std::string& text) {
+  uint64_t hash = 14695981039346656037ull;
+  for (auto c : text) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/**
+ * @brief Test cases of one shard of an executable, see --shard-index. ctest partitions the test
+ * cases of all executables at once instead, in CatchShardTests.cmake.
+ *
+ * Executables sharded by hand are partitioned on their own, so the shards are rotated by a hash of
+ * the executable name. Otherwise the first shard would collect the largest share of every
+ * executable, e.g. all executables with a single test case.
+ *
+ * @param index Shard in [0, count).
+ * @param key Name of the executable.
+ */
+inline std::vector<std::string> GetShardTests(const std::vector<std::string>& tests,
+                                              const std::vector<double>& durations, size_t index,
+                                              size_t count, const std::string& key) {
+  if (count == 0 || index >= count) return {};
+  const auto shards = PartitionTests(tests, durations, count);
+  return shards[(index + GetStableHash(key)) % count];
+}
+
+/**
+ * @brief Prints the count slowest test cases, with their setup time and result if known.
+ */
+inline void PrintSlowestTests(std::ostream& out,
+                              std::vector<std::pair<std::string, TestTiming>> timings,
+                              size_t count) {
+  if (count == 0 || timings.empty()) return;
+  std::stable_sort(timings.begin(), timings.end(),
+                   [](const auto& a, const auto& b) { return a.second.time > b.second.time; });
+  timings.resize(std::min(count, timings.size()));
+
+  out << "Slowest test cases:" << std::endl;
+  for (const auto& entry : timings) {
+    out << std::fixed << std::setprecision(3) << std::setw(10) << entry.second.time << " s  "
+        << entry.first;
+    if (entry.second.setup > 0) out << " (setup " << entry.second.setup << " s)";
+    if (!entry.second.result.empty() && entry.second.result != "passed") {
+      out << " [" << entry.second.result << "]";
+    }
+    out << std::endl;
+  }
+  out << std::defaultfloat;
+}
@@ -20,8 +20,20 @@ THE SOFTWARE.
 #pragma once
 
 #include <map>
+#include <string>
+#include <vector>
 
 const std::map<std::string, std::string> mapKernelToFileName{
   {"Set", "Set.cpp"},
   {"HipTest::vectorADD", "vectorADD.inl"},
-};
\ No newline at end of file
+};
+
+/*
+ * Name expressions of the kernels compiled ahead of time by --rtc-precompile, the template
+ * instantiations launched by the tests. Instantiations missing here are compiled on their first
+ * launch.
+ */
+const std::map<std::string, std::vector<std::string>> mapKernelToInstantiations{
+  {"Set", {"Set"}},
+  {"HipTest::vectorADD", {"HipTest::vectorADD<int>", "HipTest::vectorADD<float>"}},
+};
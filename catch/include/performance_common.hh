@@ -23,14 +23,26 @@ THE SOFTWARE.
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <map>
 #include <memory>
 #include <numeric>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
 #include <cmd_options.hh>
 #include <hip_test_common.hh>
+#include <performance_comparison.hh>
+#include <performance_counters.hh>
+#include <performance_statistics.hh>
+#include <performance_trace.hh>
 #include <resource_guards.hh>
 
 #pragma clang diagnostic ignored "-Wunused-but-set-variable"
@@ -44,69 +56,323 @@ typedef __int32 ssize_t;
 #endif  // !_WIN64
 #endif  /*_WIN32*/
 
+// True on the worker threads of Benchmark::RunThreaded
+inline bool& IsBenchmarkWorkerThread() {
+  static thread_local bool worker = false;
+  return worker;
+}
+
+/**
+ * HIP_CHECK on the main thread. On the worker threads of Benchmark::RunThreaded failures are
+ * collected like with HIP_CHECK_THREAD, successful calls are not recorded to keep the measured
+ * loop free of locking.
+ */
+#define HIP_CHECK_BENCHMARK(error)                                                                 \
+  {                                                                                                \
+    if (!IsBenchmarkWorkerThread()) {                                                              \
+      HIP_CHECK(error);                                                                            \
+    } else if (hipError_t benchmarkError = (error); benchmarkError != hipSuccess) {                \
+      TestContext::get().addResults(HCResult(__LINE__, __FILE__, benchmarkError, #error));         \
+    }                                                                                              \
+  }
+
+/**
+ * @brief Recycles the events used by EventTimer, so that after the first use of a stream no
+ * events are created or destroyed while measuring. Free events are kept per stream.
+ */
+class EventPool {
+ public:
+  EventPool() = default;
+  EventPool(const EventPool&) = delete;
+  EventPool& operator=(const EventPool&) = delete;
+
+  ~EventPool() {
+    for (auto event : events_) static_cast<void>(hipEventDestroy(event));
+  }
+
+  // Makes sure that at least count free events are available for stream
+  void Reserve(hipStream_t stream, size_t count) {
+    auto& free = free_[stream];
+    while (free.size() < count) free.push_back(Create());
+  }
+
+  hipEvent_t Acquire(hipStream_t stream) {
+    auto& free = free_[stream];
+    if (free.empty()) return Create();
+    auto event = free.back();
+    free.pop_back();
+    return event;
+  }
+
+  void Release(hipStream_t stream, hipEvent_t event) { free_[stream].push_back(event); }
+
+ private:
+  std::map<hipStream_t, std::vector<hipEvent_t>> free_;
+  std::vector<hipEvent_t> events_;  // Every event created by the pool
+
+  hipEvent_t Create() {
+    hipEvent_t event = nullptr;
+    HIP_CHECK_BENCHMARK(hipEventCreate(&event));
+    events_.push_back(event);
+    return event;
+  }
+};
+
+/**
+ * @brief State shared by the timers of a batch, see Benchmark::ConfigureBatch. The first timer of
+ * a batch starts the measurement and the last one stops it.
+ */
+struct TimerBatch {
+  size_t size = 1;
+  size_t position = 0;
+  hipEvent_t start_event = nullptr;
+  std::chrono::time_point<std::chrono::steady_clock> start_time;
+  PerfCounterValues start_counters{};
+};
+
 class Timer {
  public:
   Timer(const Timer&) = delete;
   Timer& operator=(const Timer&) = delete;
 
  protected:
-  Timer(float& time, hipStream_t stream) : time_(time), stream_(stream) {}
+  Timer(int64_t& time, hipStream_t stream, TimerBatch* batch)
+      : time_(time), stream_(stream), batch_(batch) {}
 
-  void Record(float time) { time_ += time; }
+  // Accumulates the measured time in nanoseconds
+  void Record(int64_t time) { time_ += time; }
 
   hipStream_t GetStream() const { return stream_; }
 
+  TimerBatch* GetBatch() const { return batch_; }
+
+  bool StartsBatch() const { return !batch_ || batch_->position == 0; }
+
+  bool EndsBatch() const { return !batch_ || batch_->position + 1 == batch_->size; }
+
  private:
-  float& time_;
+  int64_t& time_;
   hipStream_t stream_;
+  TimerBatch* batch_;
 };
 
 class EventTimer : public Timer {
  public:
-  EventTimer(float& time, hipStream_t stream = nullptr) : Timer(time, stream) {
-    HIP_CHECK(hipEventCreate(&start_));
-    HIP_CHECK(hipEventCreate(&stop_));
-    HIP_CHECK(hipEventRecord(start_, GetStream()));
+  EventTimer(int64_t& time, hipStream_t stream = nullptr, EventPool* pool = nullptr,
+             TimerBatch* batch = nullptr)
+      : Timer(time, stream, batch), pool_(pool) {
+    if (!StartsBatch()) {
+      start_ = GetBatch()->start_event;
+      host_start_ = GetBatch()->start_time;
+      return;
+    }
+    if (GetTraceRecorder()) host_start_ = std::chrono::steady_clock::now();
+    start_ = Acquire();
+    HIP_CHECK_BENCHMARK(hipEventRecord(start_, GetStream()));
+    if (GetBatch()) {
+      GetBatch()->start_event = start_;
+      GetBatch()->start_time = host_start_;
+    }
   }
 
   ~EventTimer() {
+    if (!EndsBatch()) return;
+
     hipError_t error;  // to avoid compiler warnings
 
-    error = hipEventRecord(stop_, GetStream());
-    error = hipEventSynchronize(stop_);
+    hipEvent_t stop = Acquire();
+    error = hipEventRecord(stop, GetStream());
+    error = hipEventSynchronize(stop);
 
     float ms;
-    error = hipEventElapsedTime(&ms, start_, stop_);
-    Record(ms);
+    error = hipEventElapsedTime(&ms, start_, stop);
+    const int64_t time = std::llround(static_cast<double>(ms) * 1e6);
+    Record(time);
+
+    Release(start_);
+    Release(stop);
 
-    error = hipEventDestroy(start_);
-    error = hipEventDestroy(stop_);
+    // The device side is shown on the track of the stream, starting with the host side
+    if (auto recorder = GetTraceRecorder()) {
+      const int64_t start = recorder->ToTraceTime(host_start_);
+      recorder->RecordThreadEvent("TIMED_SECTION", "event timer", start, recorder->Now());
+      recorder->RecordStreamEvent("TIMED_SECTION", "event timer", start, time, GetStream());
+    }
   }
 
  private:
-  hipEvent_t start_;
-  hipEvent_t stop_;
+  EventPool* pool_;
+  hipEvent_t start_ = nullptr;
+  std::chrono::time_point<std::chrono::steady_clock> host_start_;
+
+  hipEvent_t Acquire() {
+    if (pool_) return pool_->Acquire(GetStream());
+    hipEvent_t event = nullptr;
+    HIP_CHECK_BENCHMARK(hipEventCreate(&event));
+    return event;
+  }
+
+  void Release(hipEvent_t event) {
+    if (pool_) {
+      pool_->Release(GetStream(), event);
+    } else {
+      static_cast<void>(hipEventDestroy(event));
+    }
+  }
 };
 
 class CpuTimer : public Timer {
  public:
-  CpuTimer(float& time, hipStream_t stream = nullptr) : Timer(time, stream) {
+  /**
+   * @param counters Optional perf counters of the calling thread, read outside of the measured
+   * interval. The difference is added to counter_totals.
+   */
+  CpuTimer(int64_t& time, hipStream_t stream = nullptr, TimerBatch* batch = nullptr,
+           const PerfCounters* counters = nullptr, PerfCounterValues* counter_totals = nullptr)
+      : Timer(time, stream, batch), counters_(counters), counter_totals_(counter_totals) {
+    if (!StartsBatch()) {
+      start_ = GetBatch()->start_time;
+      start_counters_ = GetBatch()->start_counters;
+      return;
+    }
+    if (counters_) counters_->Read(start_counters_);
     start_ = std::chrono::steady_clock::now();
+    if (GetBatch()) {
+      GetBatch()->start_time = start_;
+      GetBatch()->start_counters = start_counters_;
+    }
   }
 
   ~CpuTimer() {
+    if (!EndsBatch()) return;
+
     hipError_t error;  // to avoid compiler warnings
     error = hipStreamSynchronize(GetStream());
 
     stop_ = std::chrono::steady_clock::now();
 
-    std::chrono::duration<float, std::milli> ms = stop_ - start_;
-    Record(ms.count());
+    Record(std::chrono::duration_cast<std::chrono::nanoseconds>(stop_ - start_).count());
+
+    if (auto recorder = GetTraceRecorder()) {
+      recorder->RecordThreadEvent("TIMED_SECTION", "cpu timer", recorder->ToTraceTime(start_),
+                                  recorder->ToTraceTime(stop_));
+    }
+
+    if (counters_ && counter_totals_) {
+      PerfCounterValues stop_counters;
+      counters_->Read(stop_counters);
+      for (size_t i = 0; i < kPerfCounterCount; ++i) {
+        (*counter_totals_)[i] += stop_counters[i] - start_counters_[i];
+      }
+    }
   }
 
  private:
   std::chrono::time_point<std::chrono::steady_clock> start_;
   std::chrono::time_point<std::chrono::steady_clock> stop_;
+  const PerfCounters* counters_;
+  PerfCounterValues* counter_totals_;
+  PerfCounterValues start_counters_{};
+};
+
+constexpr bool kTimerTypeCpu = false;
+constexpr bool kTimerTypeEvent = true;
+
+/**
+ * @brief Fills the device and build related fields of a result for the current device.
+ */
+inline void FillBenchmarkEnvironment(BenchmarkResult& result) {
+  int device = 0;
+  hipDeviceProp_t props{};
+  if (hipGetDevice(&device) == hipSuccess && hipGetDeviceProperties(&props, device) == hipSuccess) {
+    result.device_name = props.name;
+#if HT_AMD
+    result.device_arch = props.gcnArchName;
+#else
+    result.device_arch = "sm_" + std::to_string(props.major) + std::to_string(props.minor);
+#endif
+  }
+  static_cast<void>(hipRuntimeGetVersion(&result.runtime_version));
+
+  auto& context = TestContext::get();
+  result.hip_version = context.getBuildInfo("HIP_VERSION");
+  result.git_hash = context.getBuildInfo("HIP_TESTS_GITHASH");
+}
+
+/**
+ * @brief Theoretical peak memory bandwidth of the current device in GB/s, derived from the memory
+ * clock rate and bus width assuming double data rate memory. Returns 0 if either attribute is not
+ * available.
+ */
+inline double TheoreticalPeakBandwidth() {
+  int device = 0, clock_rate = 0, bus_width = 0;  // clock_rate in kHz, bus_width in bits
+  if (hipGetDevice(&device) != hipSuccess ||
+      hipDeviceGetAttribute(&clock_rate, hipDeviceAttributeMemoryClockRate, device) != hipSuccess ||
+      hipDeviceGetAttribute(&bus_width, hipDeviceAttributeMemoryBusWidth, device) != hipSuccess) {
+    return 0;
+  }
+  return 2.0 * clock_rate * 1e3 * (bus_width / 8.0) * 1e-9;
+}
+
+/**
+ * @brief Process wide sink used by Benchmark::Run. Defaults to the file passed with
+ * --benchmark-out, can be replaced to plug in a custom sink.
+ */
+inline std::shared_ptr<BenchmarkResultSink>& BenchmarkResultSinkInstance() {
+  static std::shared_ptr<BenchmarkResultSink> sink = CreateResultSink(cmd_options.benchmark_out);
+  return sink;
+}
+
+inline void SetBenchmarkResultSink(std::shared_ptr<BenchmarkResultSink> sink) {
+  BenchmarkResultSinkInstance() = std::move(sink);
+}
+
+/**
+ * @brief Baseline results loaded from the file passed with --benchmark-baseline, keyed by
+ * benchmark name. Empty if no baseline has been requested.
+ */
+inline const std::map<std::string, BenchmarkResult>& BenchmarkBaseline() {
+  static const std::map<std::string, BenchmarkResult> baseline = [] {
+    std::map<std::string, BenchmarkResult> results;
+    if (!cmd_options.benchmark_baseline.empty() &&
+        !LoadBenchmarkResults(cmd_options.benchmark_baseline, results)) {
+      std::cerr << "Unable to load benchmark baseline: " << cmd_options.benchmark_baseline
+                << std::endl;
+    }
+    return results;
+  }();
+  return baseline;
+}
+
+/**
+ * @brief Measurement state of a thread running a Benchmark. Run uses the state owned by the
+ * benchmark, RunThreaded one per worker thread.
+ */
+struct BenchmarkThreadState {
+  const void* owner = nullptr;  // Benchmark the state belongs to
+  size_t index = 0;
+  hipStream_t stream = nullptr;
+  ssize_t current = 0;
+  int64_t time = 0;      // ns
+  int64_t overhead = 0;  // Calibrated overhead of the timers of the current iteration, ns
+  TimerBatch batch;
+  EventPool event_pool;
+  std::map<std::pair<bool, hipStream_t>, int64_t> timer_overheads;  // event based, stream
+  std::unique_ptr<PerfCounters> perf_counters;  // Opened by the first CPU timer of the thread
+  PerfCounterValues perf_counter_totals{};      // Sum over the measured iterations
+};
+
+struct ThreadStatistics {
+  SampleStatistics stats;
+  double iterations_per_s = 0;  // Calls of the benchmark over the wall time of the thread
+  Throughput throughput;        // Based on the wall time of the thread
+};
+
+struct ThreadedRunStatistics {
+  SampleStatistics stats;       // Over the samples of all threads
+  double iterations_per_s = 0;  // Calls on all threads over the wall time of the slowest thread
+  Throughput throughput;        // Based on the wall time of the slowest thread
+  std::vector<ThreadStatistics> threads;
 };
 
 template <typename Derived> class Benchmark {
@@ -114,9 +380,15 @@ template <typename Derived> class Benchmark {
   Benchmark()
       : iterations_(cmd_options.iterations),
         warmups_(cmd_options.warmups),
+        min_time_(cmd_options.benchmark_min_time),
+        max_time_(cmd_options.benchmark_max_time),
+        target_rel_ci_(cmd_options.benchmark_target_rel_ci),
+        subtract_overhead_(cmd_options.benchmark_subtract_overhead),
+        perf_counters_enabled_(cmd_options.benchmark_perf_counters),
         display_output_(!cmd_options.no_display),
         progress_bar_(cmd_options.progress) {
     benchmark_name_ = Catch::getResultCapture().getCurrentTestName();
+    state_.owner = this;
   }
 
   Benchmark(const Benchmark&) = delete;
@@ -124,83 +396,473 @@ template <typename Derived> class Benchmark {
 
   static constexpr ssize_t kWarmup = -1;
 
+  // Iterations per batch in adaptive mode, also the minimum number of samples
+  static constexpr size_t kAdaptiveBatch = 10;
+  // Upper bound of samples in adaptive mode
+  static constexpr size_t kAdaptiveMaxSamples = 10000000;
+  // Time budget in seconds used in adaptive mode if no maximum time is set
+  static constexpr double kAdaptiveDefaultMaxTime = 10;
+  // Warmup ends once the medians of two successive batches differ by less than this ratio
+  static constexpr double kWarmupStability = 0.05;
+  // Number of empty timed sections measured to calibrate the overhead of a timer
+  static constexpr size_t kTimerCalibrationIterations = 100;
+
   void Configure(size_t iterations, size_t warmups) {
     iterations_ = iterations;
     warmups_ = warmups;
   }
 
+  /**
+   * @brief Measures batch_size consecutive calls of the benchmark between a single start and stop
+   * of the timer and reports their average as one sample, for operations too short to be timed
+   * individually. Only supported for benchmarks with a single TIMED_SECTION per call, anything
+   * done outside of it between two calls of a batch is measured as well.
+   */
+  void ConfigureBatch(size_t batch_size) { state_.batch.size = std::max<size_t>(batch_size, 1); }
+
+  size_t batch_size() const { return state_.batch.size; }
+
+  /**
+   * @brief Creates the events used by event based timers on stream ahead of the measurement. The
+   * events of the null stream are created by Run, events of other streams are otherwise created
+   * during the first iteration using the stream.
+   */
+  void ReserveEvents(hipStream_t stream, size_t count = 2) {
+    State().event_pool.Reserve(stream, count);
+  }
+
+  /**
+   * @brief Subtracts the calibrated overhead of every timer from the measured times, see
+   * TimerOverhead. Defaults to the --benchmark-subtract-overhead option.
+   */
+  void SubtractTimerOverhead(bool subtract) { subtract_overhead_ = subtract; }
+
+  /**
+   * @brief Reads the perf counters of the calling thread around every CPU timed section and
+   * reports their averages per iteration, see PerfCounters. Defaults to the
+   * --benchmark-perf-counters option.
+   */
+  void EnablePerfCounters(bool enable) { perf_counters_enabled_ = enable; }
+
+  // Averages per iteration of the available perf counters of the last run, keyed by name
+  const std::map<std::string, double>& perf_counter_averages() const {
+    return perf_counter_averages_;
+  }
+
+  /**
+   * @brief Median time of an empty TIMED_SECTION of the given timer type on stream, in ns. The
+   * overhead is calibrated on first use, for the null stream before the warmup of Run and for
+   * other streams when they are first timed.
+   */
+  template <bool event_based> int64_t TimerOverhead(hipStream_t stream = nullptr) {
+    auto& state = State();
+    auto [it, inserted] = state.timer_overheads.try_emplace({event_based, stream}, 0);
+    if (!inserted) return it->second;
+
+    std::vector<int64_t> samples(kTimerCalibrationIterations, 0);
+    for (auto& sample : samples) {
+      if constexpr (event_based) {
+        EventTimer timer(sample, stream, &state.event_pool);
+      } else {
+        CpuTimer timer(sample, stream);
+      }
+    }
+    return it->second = std::llround(SelectMedian(samples));
+  }
+
+  /**
+   * @brief Switches to adaptive mode, where measured iterations are added in growing batches
+   * until the relative width of the 95% confidence interval of the median drops below
+   * target_rel_ci and at least min_time seconds have passed, or max_time seconds have passed. The
+   * warmup ends as soon as two successive batches have a similar median, with the configured
+   * warmups as upper bound. Passing zero for both min_time and target_rel_ci disables the mode.
+   */
+  void ConfigureAdaptive(double min_time, double max_time, double target_rel_ci) {
+    min_time_ = min_time;
+    max_time_ = max_time;
+    target_rel_ci_ = target_rel_ci;
+  }
+
+  bool IsAdaptive() const { return min_time_ > 0 || target_rel_ci_ > 0; }
+
   void AddSectionName(const std::string& section_name) { benchmark_name_ += "/" + section_name; }
 
+  /**
+   * @brief Declares the work done by a single iteration. Run then additionally reports the
+   * bandwidth in GB/s and GiB/s, relative to the theoretical peak of the device, and the items
+   * processed per second, all based on the median iteration time.
+   */
+  void SetBytesProcessed(size_t bytes) { bytes_processed_ = bytes; }
+
+  void SetItemsProcessed(size_t items) { items_processed_ = items; }
+
+  size_t bytes_processed() const { return bytes_processed_; }
+
+  size_t items_processed() const { return items_processed_; }
+
+  // The modifier receives and returns the time of an iteration in ms
   using ModifierSignature = std::function<float(float)>;
   void RegisterModifier(const ModifierSignature& modifier) { modifier_ = modifier; }
 
-  template <typename... Args> std::tuple<float, float, float, float> Run(Args&&... args) {
-    AddSectionName(std::to_string(iterations_));
-    AddSectionName(std::to_string(warmups_));
+  /**
+   * @brief Runs the warmup and measured iterations and reports the statistics of the samples.
+   *
+   * @return the statistics of the measured iterations, in nanoseconds.
+   */
+  template <typename... Args> SampleStatistics Run(Args&&... args) {
+    // The achieved counts vary between runs in adaptive mode, keep the name stable
+    const bool adaptive = IsAdaptive();
+    AddSectionName(adaptive ? "auto" : std::to_string(iterations_));
+    AddSectionName(adaptive ? "auto" : std::to_string(warmups_));
+    if (state_.batch.size > 1) AddSectionName("batch " + std::to_string(state_.batch.size));
 
-    auto& derived = static_cast<Derived&>(*this);
+    ReserveEvents(nullptr);
+    TimerOverhead<kTimerTypeCpu>();
+    TimerOverhead<kTimerTypeEvent>();
+    if (auto recorder = GetTraceRecorder()) trace_name_ = recorder->Intern(benchmark_name_);
 
-    current_ = kWarmup;
-    for (size_t i = 0u; i < warmups_; ++i) {
-      PrintProgress("warmup", static_cast<int>(100.f * (i + 1) / warmups_));
-      derived(args...);
+    auto iteration = [&]() -> int64_t { return RunIteration(args...); };
+
+    std::vector<int64_t> samples;
+    size_t warmups = warmups_;
+    if (adaptive) {
+      warmups = RunAdaptiveWarmup(iteration);
+      RunAdaptive(iteration, samples);
+    } else {
+      state_.current = kWarmup;
+      for (size_t i = 0u; i < warmups_; ++i) {
+        PrintProgress("warmup", static_cast<int>(100.f * (i + 1) / warmups_));
+        iteration();
+      }
+
+      samples.reserve(iterations_);
+      state_.perf_counter_totals.fill(0);
+      for (state_.current = 0; state_.current < iterations_; ++state_.current) {
+        PrintProgress("measurement",
+                      static_cast<int>(100.f * (state_.current + 1) / iterations_));
+        samples.push_back(iteration());
+      }
+    }
+
+    auto stats = ComputeStatistics(samples, cmd_options.benchmark_reject_outliers);
+    Throughput throughput;
+    if (bytes_processed_ > 0 || items_processed_ > 0) {
+      throughput = ComputeThroughput(stats.median, bytes_processed_, items_processed_,
+                                     bytes_processed_ > 0 ? TheoreticalPeakBandwidth() : 0);
     }
-    time_ = .0;
 
-    std::vector<float> samples;
-    samples.reserve(iterations_);
+    const double overhead = static_cast<double>(state_.overhead) / state_.batch.size;
+    ComputePerfCounterAverages({&state_}, samples.size());
+    Report(std::move(samples), stats, throughput, warmups, overhead);
+    return stats;
+  }
 
-    for (current_ = 0; current_ < iterations_; ++current_) {
-      PrintProgress("measurement", static_cast<int>(100.f * (current_ + 1) / iterations_));
-      derived(args...);
-      if (modifier_) time_ = modifier_(time_);
-      samples.push_back(time_);
-      time_ = .0;
+  /**
+   * @brief Runs the benchmark on num_threads threads at once. Every thread gets its own stream,
+   * see stream(), and its own timers, runs its warmup iterations and then waits for all other
+   * threads before starting the measured iterations. The operator() of the benchmark is called
+   * concurrently and must use HIP_CHECK_BENCHMARK or HIP_CHECK_THREAD instead of HIP_CHECK.
+   * Adaptive iteration counts are not supported, every thread runs the configured iterations.
+   *
+   * @return the statistics of every thread and of the samples of all threads combined. Rates are
+   * based on the wall time of the measured iterations, for the aggregate that of the slowest
+   * thread.
+   */
+  template <typename... Args>
+  ThreadedRunStatistics RunThreaded(size_t num_threads, Args&&... args) {
+    num_threads = std::max<size_t>(num_threads, 1);
+    AddSectionName(std::to_string(iterations_));
+    AddSectionName(std::to_string(warmups_));
+    if (state_.batch.size > 1) AddSectionName("batch " + std::to_string(state_.batch.size));
+    AddSectionName(std::to_string(num_threads) + " threads");
+    if (auto recorder = GetTraceRecorder()) trace_name_ = recorder->Intern(benchmark_name_);
+
+    // Streams, events and the timer calibration are set up on the main thread
+    std::vector<std::unique_ptr<BenchmarkThreadState>> states;
+    for (size_t i = 0; i < num_threads; ++i) {
+      auto state = std::make_unique<BenchmarkThreadState>();
+      state->owner = this;
+      state->index = i;
+      state->batch.size = state_.batch.size;
+      HIP_CHECK(hipStreamCreate(&state->stream));
+      CurrentThreadState() = state.get();
+      ReserveEvents(state->stream);
+      TimerOverhead<kTimerTypeCpu>(state->stream);
+      TimerOverhead<kTimerTypeEvent>(state->stream);
+      CurrentThreadState() = nullptr;
+      states.push_back(std::move(state));
     }
 
-    float sum = std::accumulate(cbegin(samples), cend(samples), .0);
-    float mean = sum / samples.size();
+    std::vector<std::vector<int64_t>> samples(num_threads);
+    std::vector<double> wall_times(num_threads);  // s
+    std::atomic<size_t> waiting{0};
+    auto worker = [&](size_t index) {
+      auto& state = *states[index];
+      CurrentThreadState() = &state;
+      IsBenchmarkWorkerThread() = true;
+
+      state.current = kWarmup;
+      for (size_t i = 0u; i < warmups_; ++i) RunIteration(args...);
 
-    float deviation =
-        std::accumulate(cbegin(samples), cend(samples), .0,
-                        [mean](float sum, float next) { return sum + std::pow(next - mean, 2); });
-    deviation = sqrt(deviation / samples.size());
+      waiting.fetch_add(1);
+      while (waiting.load() < num_threads) std::this_thread::yield();
 
-    float best = *std::min_element(cbegin(samples), cend(samples));
-    float worst = *std::max_element(cbegin(samples), cend(samples));
+      state.perf_counter_totals.fill(0);
+      const auto start = std::chrono::steady_clock::now();
+      auto& thread_samples = samples[index];
+      thread_samples.reserve(iterations_);
+      for (state.current = 0; state.current < iterations_; ++state.current) {
+        thread_samples.push_back(RunIteration(args...));
+      }
+      wall_times[index] =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 
-    PrintStats(mean, deviation, best, worst);
+      IsBenchmarkWorkerThread() = false;
+      CurrentThreadState() = nullptr;
+    };
 
-    return {mean, deviation, best, worst};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_threads; ++i) threads.emplace_back(worker, i);
+    for (auto& thread : threads) thread.join();
+    HIP_CHECK_THREAD_FINALIZE();
+
+    // Rates count every call of a batch, samples are per call averages
+    const size_t calls = iterations_ * state_.batch.size;
+    auto rates = [&](double wall_time, size_t count, Throughput& throughput) {
+      if (wall_time <= 0 || count == 0) return 0.0;
+      throughput = ComputeThroughput(wall_time * 1e9 / count, bytes_processed_, items_processed_,
+                                     bytes_processed_ > 0 ? TheoreticalPeakBandwidth() : 0);
+      return count / wall_time;
+    };
+
+    ThreadedRunStatistics result;
+    std::vector<int64_t> all_samples;
+    for (size_t i = 0; i < num_threads; ++i) {
+      ThreadStatistics thread;
+      thread.stats = ComputeStatistics(samples[i], cmd_options.benchmark_reject_outliers);
+      thread.iterations_per_s = rates(wall_times[i], calls, thread.throughput);
+      PrintThread(i, thread);
+      result.threads.push_back(std::move(thread));
+      all_samples.insert(all_samples.end(), samples[i].begin(), samples[i].end());
+    }
+    result.stats = ComputeStatistics(all_samples, cmd_options.benchmark_reject_outliers);
+    result.iterations_per_s = rates(*std::max_element(wall_times.begin(), wall_times.end()),
+                                    calls * num_threads, result.throughput);
+
+    const double overhead = static_cast<double>(states.front()->overhead) / state_.batch.size;
+    std::vector<const BenchmarkThreadState*> thread_states;
+    for (const auto& state : states) thread_states.push_back(state.get());
+    ComputePerfCounterAverages(thread_states, all_samples.size());
+    for (const auto& state : states) static_cast<void>(hipStreamDestroy(state->stream));
+
+    Report(std::move(all_samples), result.stats, result.throughput, warmups_, overhead);
+    if (display_output_) {
+      Print("Aggregate: " + std::to_string(result.iterations_per_s) + " iterations/s\n");
+    }
+    return result;
   }
 
  protected:
   template <bool event_based>
   using TimerType = std::conditional_t<event_based, EventTimer, CpuTimer>;
 
+  // Returned by value, timers are neither copied nor moved thanks to guaranteed copy elision
   template <bool event_based = false>
-  std::unique_ptr<TimerType<event_based>> GetTimer(hipStream_t stream = nullptr) {
-    return std::make_unique<TimerType<event_based>>(time_, stream);
+  TimerType<event_based> GetTimer(hipStream_t stream = nullptr) {
+    auto& state = State();
+    TimerBatch* batch = state.batch.size > 1 ? &state.batch : nullptr;
+    if (!batch || batch->position + 1 == batch->size) {
+      state.overhead += TimerOverhead<event_based>(stream);
+    }
+    if constexpr (event_based) {
+      return EventTimer(state.time, stream, &state.event_pool, batch);
+    } else {
+      if (perf_counters_enabled_ && !state.perf_counters) {
+        state.perf_counters = std::make_unique<PerfCounters>();
+      }
+      return CpuTimer(state.time, stream, batch,
+                      perf_counters_enabled_ ? state.perf_counters.get() : nullptr,
+                      &state.perf_counter_totals);
+    }
   }
 
-  float time() const { return time_; }
+  // Time recorded in the current iteration up until now, in ms
+  float time() { return State().time * 1e-6f; }
 
   size_t iterations() const { return iterations_; }
 
   size_t warmups() const { return warmups_; }
 
-  ssize_t current() const { return current_; }
+  ssize_t current() { return State().current; }
+
+  // Stream of the calling thread in RunThreaded, the null stream otherwise
+  hipStream_t stream() { return State().stream; }
+
+  // Index of the calling thread in RunThreaded, 0 otherwise
+  size_t thread_index() { return State().index; }
 
  private:
   std::string benchmark_name_;
-  float time_;
   size_t iterations_;
   size_t warmups_;
-  ssize_t current_;
+  size_t bytes_processed_ = 0;
+  size_t items_processed_ = 0;
+  double min_time_;
+  double max_time_;
+  double target_rel_ci_;
+  bool subtract_overhead_;
+  bool perf_counters_enabled_;
   bool display_output_;
   bool progress_bar_;
 
   ModifierSignature modifier_;
+  BenchmarkThreadState state_;  // Used by Run and outside of the worker threads of RunThreaded
+  std::map<std::string, double> perf_counter_averages_;
+  const char* trace_name_ = nullptr;  // Interned benchmark name, set if tracing is enabled
+
+  static BenchmarkThreadState*& CurrentThreadState() {
+    static thread_local BenchmarkThreadState* state = nullptr;
+    return state;
+  }
+
+  BenchmarkThreadState& State() {
+    auto* state = CurrentThreadState();
+    return state && state->owner == this ? *state : state_;
+  }
+
+  template <typename... Args> int64_t RunIteration(Args&... args) {
+    auto& state = State();
+    auto& derived = static_cast<Derived&>(*this);
+    auto recorder = GetTraceRecorder();
+    const int64_t start = recorder ? recorder->Now() : 0;
+    state.time = 0;
+    state.overhead = 0;
+    for (state.batch.position = 0; state.batch.position < state.batch.size;
+         ++state.batch.position) {
+      derived(args...);
+    }
+    if (recorder) {
+      recorder->RecordThreadEvent(trace_name_, state.current == kWarmup ? "warmup" : "iteration",
+                                  start, recorder->Now(), "iteration", state.current);
+    }
+    if (subtract_overhead_) state.time = std::max<int64_t>(state.time - state.overhead, 0);
+    state.time /= static_cast<int64_t>(state.batch.size);
+    if (modifier_) state.time = std::llround(modifier_(state.time * 1e-6f) * 1e6);
+    return state.time;
+  }
+
+  template <typename F> size_t RunAdaptiveWarmup(F& iteration) {
+    state_.current = kWarmup;
+    std::vector<int64_t> batch(kAdaptiveBatch);
+    double previous = 0;
+    size_t count = 0;
+    while (count < warmups_) {
+      PrintProgress("warmup", static_cast<int>(100.f * count / warmups_));
+      for (auto& sample : batch) sample = iteration();
+      count += batch.size();
+
+      const double median = SelectMedian(batch);
+      if (previous > 0 && std::abs(median - previous) <= kWarmupStability * previous) break;
+      previous = median;
+    }
+    return count;
+  }
+
+  template <typename F> void RunAdaptive(F& iteration, std::vector<int64_t>& samples) {
+    using Seconds = std::chrono::duration<double>;
+    const double max_time = max_time_ > 0 ? max_time_ : kAdaptiveDefaultMaxTime;
+    const auto start = std::chrono::steady_clock::now();
+    size_t batch = kAdaptiveBatch;
+    double measuring = 0;  // Time spent in iterations, excluding the stopping checks
+    state_.current = 0;
+    state_.perf_counter_totals.fill(0);
+    while (true) {
+      const auto batch_start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < batch; ++i, ++state_.current) {
+        samples.push_back(iteration());
+      }
+      const auto batch_end = std::chrono::steady_clock::now();
+      measuring += Seconds(batch_end - batch_start).count();
+
+      const double elapsed = Seconds(batch_end - start).count();
+      PrintProgress("measurement", static_cast<int>(100 * std::min(elapsed / max_time, 1.)));
+      if (elapsed >= max_time || samples.size() >= kAdaptiveMaxSamples) break;
+      if (elapsed >= min_time_ &&
+          (target_rel_ci_ <= 0 || RelativeMedianConfidenceInterval(samples) <= target_rel_ci_)) {
+        break;
+      }
+
+      // The checks count against the time budget. The next check sorts up to twice as many
+      // samples, so twice the time of this one is reserved for it.
+      const auto now = std::chrono::steady_clock::now();
+      const double check = Seconds(now - batch_end).count();
+      const double remaining = max_time - Seconds(now - start).count() - 2 * check;
+      const double per_sample = measuring / samples.size();
+      const size_t affordable =
+          remaining > 0 ? static_cast<size_t>(std::min(remaining / per_sample, 1e18)) : 0;
+      if (affordable < kAdaptiveBatch) break;
+      // Double the number of samples with every batch, so that the checks stay a small fraction
+      // of the measurement
+      batch = std::min({samples.size(), kAdaptiveMaxSamples - samples.size(), affordable});
+    }
+  }
+
+  // Averages the perf counters available on every thread over all calls of the benchmark
+  void ComputePerfCounterAverages(const std::vector<const BenchmarkThreadState*>& states,
+                                  size_t samples) {
+    perf_counter_averages_.clear();
+    if (!perf_counters_enabled_ || samples == 0) return;
+
+    const double calls = static_cast<double>(samples) * state_.batch.size;
+    for (size_t i = 0; i < kPerfCounterCount; ++i) {
+      const auto counter = static_cast<PerfCounter>(i);
+      double total = 0;
+      bool available = true;
+      for (const auto* state : states) {
+        available = available && state->perf_counters && state->perf_counters->Available(counter);
+        total += state->perf_counter_totals[i];
+      }
+      if (available) perf_counter_averages_[GetPerfCounterName(counter)] = total / calls;
+    }
+  }
+
+  // Prints the results, compares them against the baseline and writes them to the sink
+  void Report(std::vector<int64_t> samples, const SampleStatistics& stats,
+              const Throughput& throughput, size_t warmups, double overhead) {
+    PrintStats(stats);
+    PrintThroughput(throughput);
+    PrintOverhead(overhead);
+    PrintPerfCounters();
+
+    const auto& baseline = BenchmarkBaseline();
+    if (auto it = baseline.find(benchmark_name_); it != baseline.end()) {
+      ComparisonCriteria criteria;
+      criteria.threshold = cmd_options.benchmark_threshold;
+      auto comparison = CompareSamples(it->second.samples, samples, criteria);
+      PrintComparison(comparison);
+      if (cmd_options.benchmark_fail_on_regression) {
+        INFO("Benchmark " << benchmark_name_ << " regressed from a median of "
+                          << comparison.baseline_median << " ns to " << comparison.current_median
+                          << " ns (p-value: " << comparison.p_value << ")");
+        CHECK(comparison.verdict != BenchmarkVerdict::kRegressed);
+      }
+    }
+
+    if (auto& sink = BenchmarkResultSinkInstance()) {
+      BenchmarkResult result;
+      result.name = benchmark_name_;
+      result.iterations = samples.size();
+      result.warmups = warmups;
+      result.stats = stats;
+      result.throughput = throughput;
+      result.timer_overhead = overhead;
+      result.overhead_subtracted = subtract_overhead_;
+      result.perf_counters = perf_counter_averages_;
+      result.samples = std::move(samples);
+      FillBenchmarkEnvironment(result);
+      sink->Write(result);
+    }
+  }
 
   void Print(const std::string& out = "") {
     if (!display_output_) return;
@@ -213,16 +875,81 @@ template <typename Derived> class Benchmark {
     Print(name + ": [" + std::to_string(progress) + "%]");
   }
 
-  void PrintStats(float mean, float deviation, float best, float worst) {
+  static std::string ToMs(double ns) { return std::to_string(ns * 1e-6); }
+
+  void PrintStats(const SampleStatistics& stats) {
     if (!display_output_) return;
-    Print("Average time: " + std::to_string(mean) + " ms, Standard deviation: " +
-          std::to_string(deviation) + " ms, Fastest: " + std::to_string(best) +
-          " ms, Slowest: " + std::to_string(worst) + " ms\n");
+    std::string out = "Average time: " + ToMs(stats.mean) + " ms, Standard deviation: " +
+        ToMs(stats.deviation) + " ms, Fastest: " + ToMs(stats.min) + " ms, Slowest: " +
+        ToMs(stats.max) + " ms, Median: " + ToMs(stats.median) + " ms (95% CI " +
+        ToMs(stats.median_ci.low) + " - " + ToMs(stats.median_ci.high) + ")";
+    for (const auto& [percentile, value] : stats.percentiles) {
+      if (percentile == 50) continue;
+      out += ", p" + detail::PercentileName(percentile) + ": " + ToMs(value) + " ms";
+    }
+    out += ", Outliers: " + std::to_string(stats.outliers) +
+        (stats.outliers_rejected ? " (rejected)" : "");
+    Print(out + "\n");
   }
-};
 
-constexpr bool kTimerTypeCpu = false;
-constexpr bool kTimerTypeEvent = true;
+  void PrintThroughput(const Throughput& throughput) {
+    if (!display_output_) return;
+    std::string out;
+    if (throughput.bytes_per_iteration > 0) {
+      out += "Bandwidth: " + std::to_string(throughput.gb_per_s) + " GB/s (" +
+          std::to_string(throughput.gib_per_s) + " GiB/s)";
+      if (throughput.peak_gb_per_s > 0) {
+        out += ", " + std::to_string(throughput.percent_of_peak) + "% of peak " +
+            std::to_string(throughput.peak_gb_per_s) + " GB/s";
+      }
+    }
+    if (throughput.items_per_iteration > 0) {
+      out += std::string(out.empty() ? "" : ", ") +
+          "Throughput: " + std::to_string(throughput.items_per_s) + " items/s";
+    }
+    if (!out.empty()) Print(out + "\n");
+  }
+
+  void PrintThread(size_t index, const ThreadStatistics& thread) {
+    if (!display_output_) return;
+    const auto& stats = thread.stats;
+    auto p99 = stats.percentiles.find(99);
+    Print("Thread " + std::to_string(index) + ": Median: " + ToMs(stats.median) +
+          " ms, p99: " + ToMs(p99 != stats.percentiles.end() ? p99->second : 0) + " ms, " +
+          std::to_string(thread.iterations_per_s) + " iterations/s\n");
+  }
+
+  void PrintOverhead(double overhead) {
+    if (!display_output_) return;
+    Print("Timer overhead: " + ToMs(overhead) + " ms per iteration" +
+          (subtract_overhead_ ? " (subtracted)" : "") + "\n");
+  }
+
+  void PrintPerfCounters() {
+    if (!display_output_ || !perf_counters_enabled_) return;
+    if (perf_counter_averages_.empty()) {
+      Print("Perf counters: unavailable\n");
+      return;
+    }
+    std::string out;
+    for (size_t i = 0; i < kPerfCounterCount; ++i) {
+      const auto name = GetPerfCounterName(static_cast<PerfCounter>(i));
+      auto it = perf_counter_averages_.find(name);
+      out += (i ? ", " : "") + name + ": " +
+          (it != perf_counter_averages_.end() ? std::to_string(it->second) : "n/a");
+    }
+    Print("Perf counters per iteration: " + out + "\n");
+  }
+
+  void PrintComparison(const BenchmarkComparison& comparison) {
+    if (!display_output_) return;
+    Print("Baseline median: " + ToMs(comparison.baseline_median) + " ms, Current median: " +
+          ToMs(comparison.current_median) + " ms, Change: " +
+          std::to_string(100 * comparison.relative_change) +
+          "%, p-value: " + std::to_string(comparison.p_value) + ", " +
+          GetVerdictName(comparison.verdict) + "\n");
+  }
+};
 
 #define TIMED_SECTION_STREAM(TIMER_TYPE, STREAM)                                                   \
   if (auto _ = this->template GetTimer<TIMER_TYPE>(STREAM); true)
@@ -238,6 +965,8 @@ static std::string GetAllocationSectionName(LinearAllocs allocation_type) {
   switch (allocation_type) {
     case LinearAllocs::malloc:
       return "host pageable";
+    case LinearAllocs::mallocAndRegister:
+      return "host registered";
     case LinearAllocs::hipHostMalloc:
       return "host pinned";
     case LinearAllocs::hipMalloc:
@@ -248,3 +977,238 @@ static std::string GetAllocationSectionName(LinearAllocs allocation_type) {
       return "unknown alloc type";
   }
 }
+
+static std::string GetStreamSectionName(Streams stream_type) {
+  switch (stream_type) {
+    case Streams::nullstream:
+      return "null stream";
+    case Streams::perThread:
+      return "per thread stream";
+    case Streams::created:
+      return "created stream";
+    case Streams::withFlags:
+      return "stream with flags";
+    case Streams::withPriority:
+      return "stream with priority";
+    default:
+      return "unknown stream type";
+  }
+}
+
+// Formats a size in bytes with the largest unit that divides it, e.g. 4_MB -> "4 MB"
+static std::string GetSizeSectionName(size_t size) {
+  if (size >= 1_GB && size % 1_GB == 0) return std::to_string(size >> 30) + " GB";
+  if (size >= 1_MB && size % 1_MB == 0) return std::to_string(size >> 20) + " MB";
+  if (size >= 1_KB && size % 1_KB == 0) return std::to_string(size >> 10) + " KB";
+  return std::to_string(size) + " B";
+}
+
+/**
+ * Names of the values of a sweep axis, used as section names of the benchmarks and in the result
+ * table. size_t values are sizes in bytes.
+ */
+inline std::string GetSweepValueName(size_t size) { return GetSizeSectionName(size); }
+
+inline std::string GetSweepValueName(LinearAllocs allocation_type) {
+  return GetAllocationSectionName(allocation_type);
+}
+
+inline std::string GetSweepValueName(Streams stream_type) {
+  return GetStreamSectionName(stream_type);
+}
+
+inline std::string GetSweepValueName(const std::string& value) { return value; }
+
+template <typename T>
+std::enable_if_t<std::is_arithmetic_v<T>, std::string> GetSweepValueName(T value) {
+  return std::to_string(value);
+}
+
+template <typename T> struct SweepAxis {
+  std::string name;
+  std::vector<T> values;
+};
+
+template <typename T> SweepAxis<T> Axis(const std::string& name, std::vector<T> values) {
+  return {name, std::move(values)};
+}
+
+template <typename T>
+SweepAxis<T> Axis(const std::string& name, std::initializer_list<T> values) {
+  return {name, std::vector<T>(values)};
+}
+
+/**
+ * @brief Restricts a sweep to a subset of its points. The filter has the form
+ * "axis=value[|value...][;axis=value...]", where values are compared with the names produced by
+ * GetSweepValueName, e.g. "size=4 MB|64 MB;alloc=device malloc". Axes not mentioned in the filter
+ * are not restricted.
+ */
+class SweepFilter {
+ public:
+  SweepFilter() = default;
+
+  explicit SweepFilter(const std::string& filter) {
+    std::istringstream axes(filter);
+    std::string axis;
+    while (std::getline(axes, axis, ';')) {
+      const auto separator = axis.find('=');
+      if (separator == std::string::npos) continue;
+      auto& values = allowed_[axis.substr(0, separator)];
+      std::istringstream names(axis.substr(separator + 1));
+      std::string name;
+      while (std::getline(names, name, '|')) values.insert(name);
+    }
+  }
+
+  bool Matches(const std::vector<std::string>& axes, const std::vector<std::string>& values) const {
+    for (size_t i = 0; i < axes.size() && i < values.size(); ++i) {
+      auto it = allowed_.find(axes[i]);
+      if (it != allowed_.end() && it->second.count(values[i]) == 0) return false;
+    }
+    return true;
+  }
+
+ private:
+  std::map<std::string, std::set<std::string>> allowed_;
+};
+
+struct SweepRow {
+  std::vector<std::string> values;  // Value name per axis
+  SampleStatistics stats;
+  Throughput throughput;
+};
+
+/**
+ * @brief Results of a sweep, one row per executed point in the order of execution.
+ */
+struct SweepTable {
+  std::vector<std::string> axes;
+  std::vector<SweepRow> rows;
+
+  void Print(std::ostream& out) const {
+    const bool bytes = std::any_of(rows.begin(), rows.end(), [](const SweepRow& row) {
+      return row.throughput.bytes_per_iteration > 0;
+    });
+    const bool items = std::any_of(rows.begin(), rows.end(), [](const SweepRow& row) {
+      return row.throughput.items_per_iteration > 0;
+    });
+
+    std::vector<std::string> header = axes;
+    header.insert(header.end(), {"median (ms)", "mean (ms)", "std dev (ms)", "p99 (ms)"});
+    if (bytes) header.insert(header.end(), {"GB/s", "% of peak"});
+    if (items) header.push_back("items/s");
+
+    std::vector<std::vector<std::string>> cells;
+    for (const auto& row : rows) {
+      auto line = row.values;
+      auto p99 = row.stats.percentiles.find(99);
+      for (double value : {row.stats.median, row.stats.mean, row.stats.deviation,
+                           p99 != row.stats.percentiles.end() ? p99->second : 0.0}) {
+        line.push_back(Format(value * 1e-6, 6));
+      }
+      if (bytes) {
+        line.push_back(Format(row.throughput.gb_per_s));
+        line.push_back(Format(row.throughput.percent_of_peak));
+      }
+      if (items) line.push_back(Format(row.throughput.items_per_s));
+      cells.push_back(std::move(line));
+    }
+
+    std::vector<size_t> widths(header.size());
+    for (size_t i = 0; i < header.size(); ++i) {
+      widths[i] = header[i].size();
+      for (const auto& line : cells) widths[i] = std::max(widths[i], line[i].size());
+    }
+    auto print = [&](const std::vector<std::string>& line) {
+      for (size_t i = 0; i < line.size(); ++i) {
+        out << (i ? " | " : "") << std::setw(i + 1 < line.size() ? widths[i] : 0) << std::left
+            << line[i];
+      }
+      out << std::endl;
+    };
+    print(header);
+    for (const auto& line : cells) print(line);
+  }
+
+ private:
+  static std::string Format(double value, int precision = 3) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(precision) << value;
+    return out.str();
+  }
+};
+
+namespace detail {
+template <size_t I, typename... Ts, typename F, typename... Vs>
+void ForEachSweepPoint(const std::tuple<SweepAxis<Ts>...>& axes, F& f, const Vs&... values) {
+  if constexpr (I == sizeof...(Ts)) {
+    f(values...);
+  } else {
+    for (const auto& value : std::get<I>(axes).values) {
+      ForEachSweepPoint<I + 1>(axes, f, values..., value);
+    }
+  }
+}
+}  // namespace detail
+
+/**
+ * @brief Runs a benchmark for every point of the cartesian product of named axes, e.g.
+ *
+ *   Sweep sweep(Axis("size", {4_KB, 4_MB}), Axis("alloc", {LinearAllocs::hipMalloc}));
+ *   sweep.Run<MemsetBenchmark>([](MemsetBenchmark& benchmark, size_t size, LinearAllocs alloc) {
+ *     LinearAllocGuard<void> dst(alloc, size);
+ *     benchmark.SetBytesProcessed(size);
+ *     return benchmark.Run(dst.ptr(), size);
+ *   });
+ *
+ * The first axis varies the slowest. A fresh benchmark is created per point and named after the
+ * value of every axis. Points can be excluded with the --benchmark-sweep-filter option, see
+ * SweepFilter.
+ */
+template <typename... Ts> class Sweep {
+ public:
+  explicit Sweep(SweepAxis<Ts>... axes)
+      : axes_(std::move(axes)...), filter_(cmd_options.benchmark_sweep_filter) {}
+
+  void SetFilter(const SweepFilter& filter) { filter_ = filter; }
+
+  /**
+   * @param run Callable receiving the benchmark and one value per axis and returning the
+   * statistics of the Run or RunThreaded of the benchmark. The throughput of threaded runs is
+   * based on their wall time, e.g. to sweep over the number of submitting threads.
+   * @return the table of all executed points, also printed unless the output is disabled.
+   */
+  template <typename Derived, typename F> SweepTable Run(F&& run) {
+    SweepTable table;
+    std::apply([&table](const auto&... axis) { table.axes = {axis.name...}; }, axes_);
+
+    auto point = [&](const Ts&... values) {
+      std::vector<std::string> names{GetSweepValueName(values)...};
+      if (!filter_.Matches(table.axes, names)) return;
+
+      Derived benchmark;
+      for (const auto& name : names) benchmark.AddSectionName(name);
+      const auto result = run(benchmark, values...);
+      if constexpr (std::is_same_v<std::decay_t<decltype(result)>, ThreadedRunStatistics>) {
+        table.rows.push_back({std::move(names), result.stats, result.throughput});
+      } else {
+        const Throughput throughput = ComputeThroughput(
+            result.median, benchmark.bytes_processed(), benchmark.items_processed(),
+            benchmark.bytes_processed() > 0 ? TheoreticalPeakBandwidth() : 0);
+        table.rows.push_back({std::move(names), result, throughput});
+      }
+    };
+    detail::ForEachSweepPoint<0>(axes_, point);
+
+    if (!cmd_options.no_display) {
+      std::cout << std::endl;
+      table.Print(std::cout);
+    }
+    return table;
+  }
+
+ private:
+  std::tuple<SweepAxis<Ts>...> axes_;
+  SweepFilter filter_;
+};
@@ -0,0 +1,132 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <performance_results.hh>
+
+enum class BenchmarkVerdict { kImproved, kUnchanged, kRegressed };
+
+inline std::string GetVerdictName(BenchmarkVerdict verdict) {
+  switch (verdict) {
+    case BenchmarkVerdict::kImproved:
+      return "improved";
+    case BenchmarkVerdict::kUnchanged:
+      return "unchanged";
+    case BenchmarkVerdict::kRegressed:
+      return "regressed";
+    default:
+      return "unknown";
+  }
+}
+
+/**
+ * @brief A change is only reported if it is statistically significant (p-value below alpha) and
+ * the relative change of the median exceeds threshold.
+ */
+struct ComparisonCriteria {
+  double alpha = 0.05;
+  double threshold = 0.05;
+};
+
+struct BenchmarkComparison {
+  double baseline_median = 0;  // ns
+  double current_median = 0;   // ns
+  double relative_change = 0;  // (current - baseline) / baseline, positive means slower
+  double p_value = 1;
+  BenchmarkVerdict verdict = BenchmarkVerdict::kUnchanged;
+};
+
+/**
+ * @brief Two sided Mann-Whitney U test using the normal approximation with tie and continuity
+ * correction. Suitable for the sample counts used by the benchmarks (tens and more per side).
+ *
+ * @return the p-value for the hypothesis that both sample sets come from the same distribution.
+ */
+inline double MannWhitneyU(const std::vector<int64_t>& first,
+                           const std::vector<int64_t>& second) {
+  const double n1 = first.size();
+  const double n2 = second.size();
+  if (n1 == 0 || n2 == 0) return 1;
+
+  std::vector<std::pair<int64_t, bool>> pooled;  // value, belongs to first
+  pooled.reserve(first.size() + second.size());
+  for (auto v : first) pooled.emplace_back(v, true);
+  for (auto v : second) pooled.emplace_back(v, false);
+  std::sort(pooled.begin(), pooled.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  // Assign average ranks to ties and accumulate the tie correction term
+  double rank_sum_first = 0;
+  double tie_term = 0;
+  for (size_t i = 0; i < pooled.size();) {
+    size_t j = i;
+    while (j < pooled.size() && pooled[j].first == pooled[i].first) ++j;
+    const double ties = j - i;
+    const double rank = (i + 1 + j) / 2.0;
+    for (size_t k = i; k < j; ++k) {
+      if (pooled[k].second) rank_sum_first += rank;
+    }
+    tie_term += ties * ties * ties - ties;
+    i = j;
+  }
+
+  const double n = n1 + n2;
+  const double u = rank_sum_first - n1 * (n1 + 1) / 2;
+  const double mean = n1 * n2 / 2;
+  const double variance = n1 * n2 / 12 * ((n + 1) - tie_term / (n * (n - 1)));
+  if (variance <= 0) return 1;
+
+  const double z = std::max(std::abs(u - mean) - 0.5, 0.0) / std::sqrt(variance);
+  return std::erfc(z / std::sqrt(2.0));
+}
+
+/**
+ * @brief Compares the samples of a benchmark against its baseline. Samples are times, so an
+ * increase of the median is a regression.
+ */
+inline BenchmarkComparison CompareSamples(const std::vector<int64_t>& baseline,
+                                          const std::vector<int64_t>& current,
+                                          const ComparisonCriteria& criteria = {}) {
+  BenchmarkComparison comparison;
+  comparison.baseline_median = Median(baseline);
+  comparison.current_median = Median(current);
+  if (comparison.baseline_median > 0) {
+    comparison.relative_change =
+        (comparison.current_median - comparison.baseline_median) / comparison.baseline_median;
+  }
+  comparison.p_value = MannWhitneyU(baseline, current);
+
+  if (comparison.p_value < criteria.alpha &&
+      std::abs(comparison.relative_change) > criteria.threshold) {
+    comparison.verdict = comparison.relative_change > 0 ? BenchmarkVerdict::kRegressed
+                                                        : BenchmarkVerdict::kImproved;
+  }
+  return comparison;
+}
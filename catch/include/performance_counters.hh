@@ -0,0 +1,142 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Host only hardware and software counters of the calling thread, read through perf_event_open on
+ * Linux. Counters that can not be opened, e.g. because of perf_event_paranoid, in containers or on
+ * other operating systems, are reported as unavailable.
+ */
+
+enum class PerfCounter { kCycles, kInstructions, kContextSwitches, kPageFaults, kCacheMisses };
+
+constexpr size_t kPerfCounterCount = 5;
+
+using PerfCounterValues = std::array<int64_t, kPerfCounterCount>;
+
+inline std::string GetPerfCounterName(PerfCounter counter) {
+  switch (counter) {
+    case PerfCounter::kCycles:
+      return "cycles";
+    case PerfCounter::kInstructions:
+      return "instructions";
+    case PerfCounter::kContextSwitches:
+      return "context_switches";
+    case PerfCounter::kPageFaults:
+      return "page_faults";
+    case PerfCounter::kCacheMisses:
+      return "cache_misses";
+    default:
+      return "unknown";
+  }
+}
+
+class PerfCounters {
+ public:
+  // Opens the counters for the calling thread, they count from then on
+  PerfCounters() {
+    fds_.fill(-1);
+#if defined(__linux__)
+    const std::array<std::pair<uint32_t, uint64_t>, kPerfCounterCount> events{{
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    }};
+    for (size_t i = 0; i < kPerfCounterCount; ++i) {
+      fds_[i] = Open(events[i].first, events[i].second, false);
+      // Unprivileged users may only count user space events
+      if (fds_[i] < 0) fds_[i] = Open(events[i].first, events[i].second, true);
+    }
+#endif
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  ~PerfCounters() {
+#if defined(__linux__)
+    for (auto fd : fds_) {
+      if (fd >= 0) close(fd);
+    }
+#endif
+  }
+
+  bool Available(PerfCounter counter) const { return fds_[static_cast<size_t>(counter)] >= 0; }
+
+  bool AnyAvailable() const {
+    for (auto fd : fds_) {
+      if (fd >= 0) return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Reads the current value of every counter, unavailable counters read as zero. Values
+   * are scaled by the fraction of time a counter was scheduled if the kernel had to multiplex it.
+   */
+  void Read(PerfCounterValues& values) const {
+    values.fill(0);
+#if defined(__linux__)
+    for (size_t i = 0; i < kPerfCounterCount; ++i) {
+      if (fds_[i] < 0) continue;
+      uint64_t data[3] = {};  // value, time enabled, time running
+      if (read(fds_[i], data, sizeof(data)) != sizeof(data)) continue;
+      values[i] = data[2] > 0 && data[2] < data[1]
+          ? static_cast<int64_t>(static_cast<double>(data[0]) * data[1] / data[2])
+          : static_cast<int64_t>(data[0]);
+    }
+#endif
+  }
+
+ private:
+  std::array<int, kPerfCounterCount> fds_;
+
+#if defined(__linux__)
+  static int Open(uint32_t type, uint64_t config, bool user_only) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = user_only;
+    attr.exclude_hv = user_only;
+    // Calling thread on any CPU
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+#endif
+};
@@ -0,0 +1,363 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <picojson.h>
+
+#include <performance_counters.hh>
+#include <performance_statistics.hh>
+
+/**
+ * @brief One record per executed benchmark, as written by a BenchmarkResultSink.
+ */
+struct BenchmarkResult {
+  std::string name;  // Test case name followed by every AddSectionName part
+  size_t iterations = 0;
+  size_t warmups = 0;
+  std::vector<int64_t> samples;  // Raw per iteration times in ns, in measurement order
+  SampleStatistics stats;        // Not restored by LoadBenchmarkResults
+  Throughput throughput;         // Not restored by LoadBenchmarkResults
+  double timer_overhead = 0;     // Calibrated timer overhead per sample in ns
+  bool overhead_subtracted = false;
+  std::map<std::string, double> perf_counters;  // Per iteration averages of available counters
+  std::string device_name;
+  std::string device_arch;
+  std::string hip_version;  // HIP version the tests were built against (catchInfo.txt)
+  int runtime_version = 0;  // Value reported by hipRuntimeGetVersion
+  std::string git_hash;     // hip-tests commit the tests were built from (catchInfo.txt)
+};
+
+namespace detail {
+inline bool EndsWith(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() &&
+      str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+inline std::vector<std::string> SplitCsvLine(const std::string& line) {
+  std::vector<std::string> fields(1);
+  bool quoted = false;
+  for (size_t i = 0; i < line.size(); ++i) {
+    const char c = line[i];
+    if (quoted) {
+      if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+        fields.back() += '"';
+        ++i;
+      } else if (c == '"') {
+        quoted = false;
+      } else {
+        fields.back() += c;
+      }
+    } else if (c == '"') {
+      quoted = true;
+    } else if (c == ',') {
+      fields.emplace_back();
+    } else {
+      fields.back() += c;
+    }
+  }
+  return fields;
+}
+
+// Parses a whole field as a decimal integer, false if it is empty, not a number or out of range
+template <typename T> bool ParseInteger(const std::string& field, T& value) {
+  const char* end = field.data() + field.size();
+  const auto result = std::from_chars(field.data(), end, value);
+  return result.ec == std::errc() && result.ptr == end;
+}
+
+// Formats a percentile for use in keys, e.g. 99.9 -> "99.9" and 50 -> "50"
+inline std::string PercentileName(double percentile) {
+  std::ostringstream name;
+  name << percentile;
+  return name.str();
+}
+}  // namespace detail
+
+class BenchmarkResultSink {
+ public:
+  virtual ~BenchmarkResultSink() = default;
+
+  virtual void Write(const BenchmarkResult& result) = 0;
+};
+
+/**
+ * @brief Writes a result per line as a JSON object. Lines are appended, so every test process
+ * launched by ctest can share the same output file.
+ */
+class JsonLinesResultSink : public BenchmarkResultSink {
+ public:
+  explicit JsonLinesResultSink(const std::string& path) : out_(path, std::ios::app) {}
+
+  void Write(const BenchmarkResult& result) override {
+    if (!out_.is_open()) return;
+    out_ << ToJson(result).serialize() << std::endl;
+  }
+
+  static picojson::value ToJson(const BenchmarkResult& result) {
+    picojson::array samples;
+    samples.reserve(result.samples.size());
+    for (auto sample : result.samples) {
+      samples.emplace_back(static_cast<double>(sample));
+    }
+
+    picojson::object percentiles;
+    for (const auto& [percentile, value] : result.stats.percentiles) {
+      percentiles[detail::PercentileName(percentile)] = picojson::value(value);
+    }
+
+    const auto& stats = result.stats;
+    picojson::object o;
+    o["name"] = picojson::value(result.name);
+    o["iterations"] = picojson::value(static_cast<double>(result.iterations));
+    o["warmups"] = picojson::value(static_cast<double>(result.warmups));
+    o["samples_ns"] = picojson::value(samples);
+    o["mean_ns"] = picojson::value(stats.mean);
+    o["stddev_ns"] = picojson::value(stats.deviation);
+    o["min_ns"] = picojson::value(stats.min);
+    o["max_ns"] = picojson::value(stats.max);
+    o["median_ns"] = picojson::value(stats.median);
+    o["mad_ns"] = picojson::value(stats.mad);
+    o["percentiles_ns"] = picojson::value(percentiles);
+    o["outliers"] = picojson::value(static_cast<double>(stats.outliers));
+    o["outliers_rejected"] = picojson::value(stats.outliers_rejected);
+    o["median_ci_ns"] = picojson::value(picojson::array{picojson::value(stats.median_ci.low),
+                                                        picojson::value(stats.median_ci.high)});
+    o["mean_ci_ns"] = picojson::value(picojson::array{picojson::value(stats.mean_ci.low),
+                                                      picojson::value(stats.mean_ci.high)});
+    o["timer_overhead_ns"] = picojson::value(result.timer_overhead);
+    o["overhead_subtracted"] = picojson::value(result.overhead_subtracted);
+    picojson::object perf_counters;
+    for (const auto& [name, value] : result.perf_counters) {
+      perf_counters[name] = picojson::value(value);
+    }
+    o["perf_counters"] = picojson::value(perf_counters);
+    const auto& throughput = result.throughput;
+    o["bytes_per_iteration"] = picojson::value(static_cast<double>(throughput.bytes_per_iteration));
+    o["items_per_iteration"] = picojson::value(static_cast<double>(throughput.items_per_iteration));
+    o["gb_per_s"] = picojson::value(throughput.gb_per_s);
+    o["gib_per_s"] = picojson::value(throughput.gib_per_s);
+    o["items_per_s"] = picojson::value(throughput.items_per_s);
+    o["peak_gb_per_s"] = picojson::value(throughput.peak_gb_per_s);
+    o["percent_of_peak"] = picojson::value(throughput.percent_of_peak);
+    o["device_name"] = picojson::value(result.device_name);
+    o["device_arch"] = picojson::value(result.device_arch);
+    o["hip_version"] = picojson::value(result.hip_version);
+    o["runtime_version"] = picojson::value(static_cast<double>(result.runtime_version));
+    o["git_hash"] = picojson::value(result.git_hash);
+    return picojson::value(o);
+  }
+
+ private:
+  std::ofstream out_;
+};
+
+/**
+ * @brief Writes a result per line as comma separated values. The raw samples are stored as a
+ * single space separated field. The header is only written if the file is empty.
+ */
+class CsvResultSink : public BenchmarkResultSink {
+ public:
+  explicit CsvResultSink(const std::string& path) : out_(path, std::ios::app) {
+    if (!out_.is_open()) return;
+    out_.seekp(0, std::ios::end);
+    if (out_.tellp() == 0) {
+      out_ << "name,iterations,warmups,mean_ns,stddev_ns,min_ns,max_ns,median_ns,mad_ns,";
+      for (auto percentile : kReportedPercentiles) {
+        out_ << "p" << detail::PercentileName(percentile) << "_ns,";
+      }
+      for (size_t i = 0; i < kPerfCounterCount; ++i) {
+        out_ << "perf_" << GetPerfCounterName(static_cast<PerfCounter>(i)) << ",";
+      }
+      out_ << "outliers,outliers_rejected,median_ci_low_ns,median_ci_high_ns,mean_ci_low_ns,"
+              "mean_ci_high_ns,timer_overhead_ns,overhead_subtracted,bytes_per_iteration,"
+              "items_per_iteration,gb_per_s,gib_per_s,items_per_s,peak_gb_per_s,percent_of_peak,"
+              "device_name,device_arch,hip_version,runtime_version,git_hash,samples_ns"
+           << std::endl;
+    }
+  }
+
+  void Write(const BenchmarkResult& result) override {
+    if (!out_.is_open()) return;
+
+    std::ostringstream samples;
+    for (size_t i = 0; i < result.samples.size(); ++i) {
+      samples << (i ? " " : "") << result.samples[i];
+    }
+
+    const auto& stats = result.stats;
+    const auto& throughput = result.throughput;
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(3);
+    line << Quote(result.name) << ',' << result.iterations << ',' << result.warmups << ','
+         << stats.mean << ',' << stats.deviation << ',' << stats.min << ',' << stats.max << ','
+         << stats.median << ',' << stats.mad << ',';
+    for (auto percentile : kReportedPercentiles) {
+      auto it = stats.percentiles.find(percentile);
+      if (it != stats.percentiles.end()) line << it->second;
+      line << ',';
+    }
+    for (size_t i = 0; i < kPerfCounterCount; ++i) {
+      auto it = result.perf_counters.find(GetPerfCounterName(static_cast<PerfCounter>(i)));
+      if (it != result.perf_counters.end()) line << it->second;
+      line << ',';
+    }
+    line << stats.outliers << ',' << stats.outliers_rejected << ',' << stats.median_ci.low << ','
+         << stats.median_ci.high << ',' << stats.mean_ci.low << ',' << stats.mean_ci.high << ','
+         << result.timer_overhead << ',' << result.overhead_subtracted << ','
+         << throughput.bytes_per_iteration << ',' << throughput.items_per_iteration << ','
+         << throughput.gb_per_s << ',' << throughput.gib_per_s << ',' << throughput.items_per_s
+         << ',' << throughput.peak_gb_per_s << ',' << throughput.percent_of_peak << ','
+         << Quote(result.device_name) << ',' << Quote(result.device_arch) << ','
+         << Quote(result.hip_version) << ',' << result.runtime_version << ','
+         << Quote(result.git_hash) << ',' << Quote(samples.str());
+    out_ << line.str() << std::endl;
+  }
+
+ private:
+  std::ofstream out_;
+
+  static std::string Quote(const std::string& field) {
+    std::string quoted = "\"";
+    for (auto c : field) {
+      if (c == '"') quoted += '"';
+      quoted += c;
+    }
+    return quoted + "\"";
+  }
+};
+
+
+/**
+ * @brief Creates a sink based on the file extension, ".csv" selects CSV and anything else JSON
+ * Lines. Returns nullptr for an empty path.
+ */
+inline std::shared_ptr<BenchmarkResultSink> CreateResultSink(const std::string& path) {
+  if (path.empty()) return nullptr;
+
+  if (detail::EndsWith(path, ".csv")) {
+    return std::make_shared<CsvResultSink>(path);
+  }
+  return std::make_shared<JsonLinesResultSink>(path);
+}
+
+/**
+ * @brief Reads back a file written by one of the sinks. Records are keyed by benchmark name, if a
+ * name occurs more than once the last record wins. Only the samples and the environment are
+ * restored, use ComputeStatistics to derive the statistics.
+ *
+ * @param path Path of a JSON Lines or CSV file, the format is selected the same way as in
+ * CreateResultSink.
+ * @param results Filled with the records of the file.
+ * @return false if the file could not be opened or contains a malformed record.
+ */
+inline bool LoadBenchmarkResults(const std::string& path,
+                                 std::map<std::string, BenchmarkResult>& results) {
+  std::ifstream in(path);
+  if (!in.is_open()) return false;
+
+  const bool csv = detail::EndsWith(path, ".csv");
+  std::vector<std::string> header;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty()) continue;
+    BenchmarkResult result;
+
+    if (csv) {
+      auto fields = detail::SplitCsvLine(line);
+      if (header.empty()) {
+        header = std::move(fields);
+        continue;
+      }
+      if (fields.size() != header.size()) return false;
+      for (size_t i = 0; i < fields.size(); ++i) {
+        const auto& key = header[i];
+        const auto& value = fields[i];
+        bool valid = true;
+        if (key == "name") result.name = value;
+        else if (key == "iterations") valid = detail::ParseInteger(value, result.iterations);
+        else if (key == "warmups") valid = detail::ParseInteger(value, result.warmups);
+        else if (key == "device_name") result.device_name = value;
+        else if (key == "device_arch") result.device_arch = value;
+        else if (key == "hip_version") result.hip_version = value;
+        else if (key == "runtime_version") {
+          valid = detail::ParseInteger(value, result.runtime_version);
+        } else if (key == "git_hash") result.git_hash = value;
+        else if (key == "samples_ns") {
+          std::istringstream samples(value);
+          int64_t sample;
+          while (samples >> sample) result.samples.push_back(sample);
+          valid = samples.eof();
+        }
+        if (!valid) return false;
+      }
+    } else {
+      picojson::value v;
+      std::string err = picojson::parse(v, line);
+      if (!err.empty() || !v.is<picojson::object>()) return false;
+
+      const auto& o = v.get<picojson::object>();
+      auto get = [&o](const std::string& key) -> const picojson::value* {
+        auto it = o.find(key);
+        return it != o.end() ? &it->second : nullptr;
+      };
+      auto get_string = [&get](const std::string& key) {
+        auto value = get(key);
+        return value && value->is<std::string>() ? value->get<std::string>() : std::string("");
+      };
+      auto get_number = [&get](const std::string& key) {
+        auto value = get(key);
+        return value && value->is<double>() ? value->get<double>() : 0.0;
+      };
+
+      result.name = get_string("name");
+      result.iterations = static_cast<size_t>(get_number("iterations"));
+      result.warmups = static_cast<size_t>(get_number("warmups"));
+      result.device_name = get_string("device_name");
+      result.device_arch = get_string("device_arch");
+      result.hip_version = get_string("hip_version");
+      result.runtime_version = static_cast<int>(get_number("runtime_version"));
+      result.git_hash = get_string("git_hash");
+      if (auto samples = get("samples_ns"); samples && samples->is<picojson::array>()) {
+        for (const auto& sample : samples->get<picojson::array>()) {
+          if (sample.is<double>()) {
+            result.samples.push_back(static_cast<int64_t>(sample.get<double>()));
+          }
+        }
+      }
+    }
+
+    if (result.name.empty()) return false;
+    results[result.name] = std::move(result);
+  }
+  return true;
+}
@@ -0,0 +1,286 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <vector>
+
+/**
+ * Host only statistics over benchmark samples. Samples are integer nanoseconds, all derived values
+ * are computed in double precision and are expressed in nanoseconds as well.
+ */
+
+// Percentiles reported for every benchmark
+inline const std::vector<double> kReportedPercentiles = {50, 90, 95, 99, 99.9};
+
+// Samples with a modified z-score above this value are flagged as outliers (Iglewicz and Hoaglin)
+constexpr double kOutlierThreshold = 3.5;
+
+// Scales the MAD to be a consistent estimator of the standard deviation for normal data
+constexpr double kMadScale = 1.4826;
+
+struct ConfidenceInterval {
+  double low = 0;
+  double high = 0;
+};
+
+struct SampleStatistics {
+  size_t count = 0;
+  double mean = 0;
+  double deviation = 0;  // Population standard deviation
+  double min = 0;
+  double max = 0;
+  double median = 0;
+  double mad = 0;  // Median absolute deviation, not scaled
+  std::map<double, double> percentiles;
+  size_t outliers = 0;  // Number of samples flagged by FlagOutliers
+  bool outliers_rejected = false;  // mean, deviation, min and max exclude the outliers
+  ConfidenceInterval median_ci;
+  ConfidenceInterval mean_ci;
+};
+
+/**
+ * @brief Work rates derived from the work declared per iteration and the median iteration time.
+ * Rates are zero if no work of the respective kind has been declared.
+ */
+struct Throughput {
+  size_t bytes_per_iteration = 0;
+  size_t items_per_iteration = 0;
+  double gb_per_s = 0;   // 10^9 bytes per second
+  double gib_per_s = 0;  // 2^30 bytes per second
+  double items_per_s = 0;
+  double peak_gb_per_s = 0;    // Theoretical peak bandwidth of the device, 0 if unknown
+  double percent_of_peak = 0;  // gb_per_s relative to peak_gb_per_s, 0 if the peak is unknown
+};
+
+/**
+ * @brief Percentile of sorted samples using linear interpolation between the closest ranks.
+ *
+ * @param sorted Samples sorted in ascending order.
+ * @param percentile Value in [0, 100].
+ */
+template <typename T> double Percentile(const std::vector<T>& sorted, double percentile) {
+  if (sorted.empty()) return 0;
+  const double rank = std::clamp(percentile, 0.0, 100.0) / 100 * (sorted.size() - 1);
+  const size_t lower = static_cast<size_t>(std::floor(rank));
+  const size_t upper = std::min(lower + 1, sorted.size() - 1);
+  const double fraction = rank - lower;
+  return static_cast<double>(sorted[lower]) +
+      fraction * (static_cast<double>(sorted[upper]) - static_cast<double>(sorted[lower]));
+}
+
+/**
+ * @brief Median of samples that may be reordered, cheaper than sorting them.
+ */
+template <typename T> double SelectMedian(std::vector<T>& samples) {
+  if (samples.empty()) return 0;
+  const size_t mid = samples.size() / 2;
+  std::nth_element(samples.begin(), samples.begin() + mid, samples.end());
+  double median = samples[mid];
+  if (samples.size() % 2 == 0) {
+    median = (median + *std::max_element(samples.begin(), samples.begin() + mid)) / 2;
+  }
+  return median;
+}
+
+template <typename T> double Median(std::vector<T> samples) {
+  std::sort(samples.begin(), samples.end());
+  return Percentile(samples, 50);
+}
+
+template <typename T>
+double MedianAbsoluteDeviation(const std::vector<T>& samples, double median) {
+  std::vector<double> deviations;
+  deviations.reserve(samples.size());
+  for (auto sample : samples) deviations.push_back(std::abs(sample - median));
+  return Median(std::move(deviations));
+}
+
+/**
+ * @brief Flags samples whose modified z-score, |x - median| / (1.4826 * MAD), exceeds threshold.
+ * Nothing is flagged if more than half of the samples are identical (MAD of zero).
+ */
+template <typename T>
+std::vector<bool> FlagOutliers(const std::vector<T>& samples,
+                               double threshold = kOutlierThreshold) {
+  std::vector<bool> outliers(samples.size(), false);
+  const double median = Median(samples);
+  const double mad = MedianAbsoluteDeviation(samples, median);
+  if (mad == 0) return outliers;
+
+  for (size_t i = 0; i < samples.size(); ++i) {
+    outliers[i] = std::abs(samples[i] - median) / (kMadScale * mad) > threshold;
+  }
+  return outliers;
+}
+
+/**
+ * @brief Critical value z of the standard normal distribution for a two sided interval, so that
+ * P(|Z| <= z) = confidence, e.g. 1.96 for 0.95.
+ */
+inline double NormalCriticalValue(double confidence) {
+  const double tail = 1 - std::clamp(confidence, 0.0, 1 - 1e-15);
+  double low = 0, high = 40;
+  for (int i = 0; i < 100; ++i) {
+    const double z = (low + high) / 2;
+    if (std::erfc(z / std::sqrt(2.0)) > tail) {
+      low = z;
+    } else {
+      high = z;
+    }
+  }
+  return (low + high) / 2;
+}
+
+/**
+ * @brief Distribution free confidence interval of the median, from the order statistics at the
+ * binomial ranks n/2 -+ z * sqrt(n) / 2. Needs no resampling, so it is cheap for any sample count.
+ *
+ * @param sorted Samples sorted in ascending order.
+ */
+template <typename T>
+ConfidenceInterval MedianConfidenceInterval(const std::vector<T>& sorted,
+                                            double confidence = 0.95) {
+  if (sorted.empty()) return {};
+  const double n = sorted.size();
+  const double spread = NormalCriticalValue(confidence) * std::sqrt(n) / 2;
+  // 1 based ranks, clamped to the samples
+  const double lower = std::clamp(std::floor(n / 2 - spread), 1.0, n);
+  const double upper = std::clamp(std::ceil(1 + n / 2 + spread), 1.0, n);
+  return {static_cast<double>(sorted[static_cast<size_t>(lower) - 1]),
+          static_cast<double>(sorted[static_cast<size_t>(upper) - 1])};
+}
+
+/**
+ * @brief Normal approximation of the confidence interval of the mean, mean -+ z * deviation /
+ * sqrt(count).
+ */
+inline ConfidenceInterval MeanConfidenceInterval(double mean, double deviation, size_t count,
+                                                 double confidence = 0.95) {
+  if (count == 0) return {};
+  const double spread = NormalCriticalValue(confidence) * deviation / std::sqrt(count);
+  return {mean - spread, mean + spread};
+}
+
+template <typename T> double Mean(const std::vector<T>& samples) {
+  if (samples.empty()) return 0;
+  return std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+/**
+ * @brief Computes all statistics reported for a benchmark.
+ *
+ * @param samples The measured samples in nanoseconds.
+ * @param reject_outliers Compute mean, deviation, min and max without the flagged outliers.
+ * Median, percentiles and the median confidence interval always use every sample. The confidence
+ * intervals are computed analytically, in O(n log n) overall.
+ * @param percentiles Percentiles to compute, in [0, 100].
+ */
+inline SampleStatistics ComputeStatistics(const std::vector<int64_t>& samples,
+                                          bool reject_outliers = false,
+                                          const std::vector<double>& percentiles =
+                                              kReportedPercentiles) {
+  SampleStatistics stats;
+  stats.count = samples.size();
+  if (samples.empty()) return stats;
+
+  std::vector<int64_t> sorted = samples;
+  std::sort(sorted.begin(), sorted.end());
+  stats.median = Percentile(sorted, 50);
+  stats.mad = MedianAbsoluteDeviation(sorted, stats.median);
+  for (auto percentile : percentiles) {
+    stats.percentiles[percentile] = Percentile(sorted, percentile);
+  }
+
+  const auto outliers = FlagOutliers(samples);
+  stats.outliers = std::count(outliers.begin(), outliers.end(), true);
+  stats.outliers_rejected = reject_outliers && stats.outliers > 0;
+
+  std::vector<int64_t> kept;
+  if (stats.outliers_rejected) {
+    kept.reserve(samples.size() - stats.outliers);
+    for (size_t i = 0; i < samples.size(); ++i) {
+      if (!outliers[i]) kept.push_back(samples[i]);
+    }
+  }
+  const auto& used = stats.outliers_rejected ? kept : samples;
+
+  stats.mean = Mean(used);
+  const double mean = stats.mean;
+  stats.deviation = std::sqrt(std::accumulate(used.begin(), used.end(), 0.0,
+                                              [mean](double sum, int64_t next) {
+                                                return sum + (next - mean) * (next - mean);
+                                              }) /
+                              used.size());
+  stats.min = *std::min_element(used.begin(), used.end());
+  stats.max = *std::max_element(used.begin(), used.end());
+
+  stats.median_ci = MedianConfidenceInterval(sorted);
+  stats.mean_ci = MeanConfidenceInterval(stats.mean, stats.deviation, used.size());
+
+  return stats;
+}
+
+/**
+ * @brief Width of the confidence interval of the median relative to the median. Sorts a copy of
+ * the samples, O(n log n), so it can be checked repeatedly while samples are collected.
+ */
+inline double RelativeMedianConfidenceInterval(const std::vector<int64_t>& samples,
+                                               double confidence = 0.95) {
+  std::vector<int64_t> sorted = samples;
+  std::sort(sorted.begin(), sorted.end());
+  const double median = Percentile(sorted, 50);
+  if (median <= 0) return 0;
+  const auto ci = MedianConfidenceInterval(sorted, confidence);
+  return (ci.high - ci.low) / median;
+}
+
+/**
+ * @brief Computes the work rates of a benchmark.
+ *
+ * @param time Time of an iteration in nanoseconds, usually the median.
+ * @param bytes Bytes processed per iteration.
+ * @param items Items processed per iteration.
+ * @param peak_gb_per_s Theoretical peak bandwidth in GB/s, 0 if unknown.
+ */
+inline Throughput ComputeThroughput(double time, size_t bytes, size_t items,
+                                    double peak_gb_per_s = 0) {
+  Throughput throughput;
+  throughput.bytes_per_iteration = bytes;
+  throughput.items_per_iteration = items;
+  if (time <= 0) return throughput;
+
+  const double seconds = time * 1e-9;
+  throughput.gb_per_s = bytes / seconds * 1e-9;
+  throughput.gib_per_s = bytes / seconds / (1ull << 30);
+  throughput.items_per_s = items / seconds;
+  if (bytes > 0 && peak_gb_per_s > 0) {
+    throughput.peak_gb_per_s = peak_gb_per_s;
+    throughput.percent_of_peak = 100 * throughput.gb_per_s / peak_gb_per_s;
+  }
+  return throughput;
+}
@@ -0,0 +1,193 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * Host only recorder of timeline events, written in the Chrome trace event format that can be
+ * opened in Perfetto or chrome://tracing. Events are stored in a ring buffer allocated up front,
+ * recording an event takes an atomic increment and a copy without any allocation. Once the buffer
+ * is full the oldest events are overwritten.
+ */
+
+struct TraceEvent {
+  const char* name = nullptr;      // Literal or interned with TraceRecorder::Intern
+  const char* category = nullptr;  // Literal
+  int64_t start = 0;               // ns since the start of the trace
+  int64_t duration = 0;            // ns
+  uint64_t track = 0;              // Host thread index or stream handle
+  bool stream = false;             // The track is a stream instead of a host thread
+  const char* arg_name = nullptr;  // Optional integer argument shown with the event
+  int64_t arg = 0;
+};
+
+class TraceRecorder {
+ public:
+  // Default capacity of the ring buffer, in events
+  static constexpr size_t kDefaultCapacity = 1 << 18;
+
+  explicit TraceRecorder(size_t capacity = kDefaultCapacity)
+      : events_(capacity), epoch_(std::chrono::steady_clock::now()) {}
+
+  TraceRecorder(const TraceRecorder&) = delete;
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  // Returns a pointer to a copy of name that stays valid as long as the recorder, not meant for
+  // the hot path
+  const char* Intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(names_mutex_);
+    return names_.insert(name).first->c_str();
+  }
+
+  int64_t ToTraceTime(std::chrono::steady_clock::time_point time) const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time - epoch_).count();
+  }
+
+  int64_t Now() const { return ToTraceTime(std::chrono::steady_clock::now()); }
+
+  // Small index of the calling thread, used as its track
+  static uint64_t ThreadIndex() {
+    static std::atomic<uint64_t> next{1};
+    static thread_local const uint64_t index = next.fetch_add(1);
+    return index;
+  }
+
+  void Record(const TraceEvent& event) {
+    const auto slot = next_.fetch_add(1, std::memory_order_relaxed);
+    events_[slot % events_.size()] = event;
+  }
+
+  void RecordThreadEvent(const char* name, const char* category, int64_t start, int64_t end,
+                         const char* arg_name = nullptr, int64_t arg = 0) {
+    Record({name, category, start, end - start, ThreadIndex(), false, arg_name, arg});
+  }
+
+  template <typename Stream>
+  void RecordStreamEvent(const char* name, const char* category, int64_t start, int64_t duration,
+                         Stream stream) {
+    Record({name, category, start, duration, reinterpret_cast<uintptr_t>(stream), true});
+  }
+
+  size_t size() const { return std::min<size_t>(next_.load(), events_.size()); }
+
+  size_t dropped() const { return next_.load() - size(); }
+
+  /**
+   * @brief Writes all recorded events as trace event JSON. Host threads and streams are shown as
+   * separate processes with one track per thread or stream. Must not be called while events are
+   * recorded.
+   */
+  bool Write(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+
+    const uint64_t count = next_.load();
+    const uint64_t first = count > events_.size() ? count - events_.size() : 0;
+    std::set<uint64_t> threads, streams;
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << std::fixed << std::setprecision(3);
+    for (uint64_t i = first; i < count; ++i) {
+      const auto& event = events_[i % events_.size()];
+      (event.stream ? streams : threads).insert(event.track);
+      out << "{\"name\":\"" << Escape(event.name) << "\",\"cat\":\"" << Escape(event.category)
+          << "\",\"ph\":\"X\",\"ts\":" << event.start * 1e-3
+          << ",\"dur\":" << event.duration * 1e-3
+          << ",\"pid\":" << (event.stream ? kStreamsPid : kThreadsPid)
+          << ",\"tid\":" << event.track;
+      if (event.arg_name) {
+        out << ",\"args\":{\"" << Escape(event.arg_name) << "\":" << event.arg << "}";
+      }
+      out << "},\n";
+    }
+
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << kThreadsPid
+        << ",\"args\":{\"name\":\"Host threads\"}},\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << kStreamsPid
+        << ",\"args\":{\"name\":\"Streams\"}}";
+    for (auto thread : threads) {
+      out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << kThreadsPid
+          << ",\"tid\":" << thread << ",\"args\":{\"name\":\"thread " << thread << "\"}}";
+    }
+    for (auto stream : streams) {
+      out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << kStreamsPid
+          << ",\"tid\":" << stream << ",\"args\":{\"name\":\"";
+      if (stream == 0) {
+        out << "null stream";
+      } else {
+        out << "stream 0x" << std::hex << stream << std::dec;
+      }
+      out << "\"}}";
+    }
+    out << "\n]}" << std::endl;
+    return out.good();
+  }
+
+ private:
+  static constexpr int kThreadsPid = 1;
+  static constexpr int kStreamsPid = 2;
+
+  std::vector<TraceEvent> events_;
+  std::atomic<uint64_t> next_{0};
+  const std::chrono::steady_clock::time_point epoch_;
+  std::mutex names_mutex_;
+  std::set<std::string> names_;
+
+  static std::string Escape(const char* str) {
+    std::string escaped;
+    for (; str && *str; ++str) {
+      const char c = *str;
+      if (c == '"' || c == '\\') {
+        escaped += '\\';
+        escaped += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        escaped += ' ';
+      } else {
+        escaped += c;
+      }
+    }
+    return escaped;
+  }
+};
+
+/**
+ * @brief Process wide recorder, only created if tracing has been requested with --trace-out.
+ */
+inline std::unique_ptr<TraceRecorder>& TraceRecorderInstance() {
+  static std::unique_ptr<TraceRecorder> recorder;
+  return recorder;
+}
+
+// Returns nullptr if tracing is disabled
+inline TraceRecorder* GetTraceRecorder() { return TraceRecorderInstance().get(); }
@@ -54,6 +54,33 @@ TEST_CASE("Performance_Example") {
   // to override cmd options
   // benchmark.Configure(10000 /* iterations */, 1000 /* warmups */);
 
+  // both timed sections write 4 MB, reported as bandwidth in addition to the time
+  benchmark.SetBytesProcessed(2 * 4_MB);
+
   LinearAllocGuard<void> dst(LinearAllocs::hipMalloc, 4_MB);
   benchmark.Run(dst.ptr());
 }
+
+class ExampleSweepBenchmark : public Benchmark<ExampleSweepBenchmark> {
+ public:
+  void operator()(void* dst, size_t size, hipStream_t stream) {
+    TIMED_SECTION_STREAM(kTimerTypeEvent, stream) {
+      HIP_CHECK(hipMemsetAsync(dst, 42, size, stream));
+    }
+  }
+};
+
+TEST_CASE("Performance_Example_Sweep") {
+  // runs every combination, restrict with e.g. --benchmark-sweep-filter "size=4 MB"
+  Sweep sweep(Axis("size", {4_KB, 4_MB, 64_MB}),
+              Axis("alloc", {LinearAllocs::hipMalloc, LinearAllocs::hipMallocManaged}),
+              Axis("stream", {Streams::nullstream, Streams::created}));
+
+  sweep.Run<ExampleSweepBenchmark>([](ExampleSweepBenchmark& benchmark, size_t size,
+                                      LinearAllocs alloc, Streams stream_type) {
+    LinearAllocGuard<void> dst(alloc, size);
+    StreamGuard stream(stream_type);
+    benchmark.SetBytesProcessed(size);
+    return benchmark.Run(dst.ptr(), size, stream.stream());
+  });
+}
@@ -0,0 +1,112 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <performance_common.hh>
+
+/**
+ * @addtogroup framework framework
+ * @{
+ * @ingroup PerformanceTest
+ */
+
+class SpinBenchmark : public Benchmark<SpinBenchmark> {
+ public:
+  void operator()(std::chrono::microseconds duration) {
+    TIMED_SECTION(kTimerTypeCpu) {
+      const auto end = std::chrono::steady_clock::now() + duration;
+      while (std::chrono::steady_clock::now() < end) {
+      }
+    }
+  }
+};
+
+class JitterBenchmark : public Benchmark<JitterBenchmark> {
+ public:
+  void operator()(std::chrono::microseconds duration) {
+    // Cycle through distinct durations so the median interval never collapses to zero width
+    const auto spin = duration * (1 + samples_taken_++ % 4);
+    TIMED_SECTION(kTimerTypeCpu) {
+      const auto end = std::chrono::steady_clock::now() + spin;
+      while (std::chrono::steady_clock::now() < end) {
+      }
+    }
+  }
+
+ private:
+  size_t samples_taken_ = 0;
+};
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Runs a host only benchmark with adaptive iteration counts and checks that the measurement
+ *    honours the minimum time and the time budget, including the cost of the stopping checks.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkAdaptive.cc
+ */
+TEST_CASE("Unit_Benchmark_AdaptiveIterations") {
+  SpinBenchmark benchmark;
+  benchmark.Configure(1000, 100);
+
+  SECTION("Target confidence interval") {
+    benchmark.ConfigureAdaptive(0, 5, 0.05);
+    REQUIRE(benchmark.IsAdaptive());
+    const auto stats = benchmark.Run(std::chrono::microseconds(20));
+    REQUIRE(stats.count >= SpinBenchmark::kAdaptiveBatch);
+    REQUIRE(stats.count < 1000);
+  }
+
+  SECTION("Minimum time") {
+    benchmark.ConfigureAdaptive(0.1, 5, 0);
+    const auto start = std::chrono::steady_clock::now();
+    const auto stats = benchmark.Run(std::chrono::microseconds(100));
+    REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(100));
+    REQUIRE(stats.count >= 100.0 / 0.1 / 2);  // Samples double with every batch
+  }
+
+  SECTION("Time budget") {
+    benchmark.ConfigureAdaptive(0, 0.05, 1e-9);
+    const auto start = std::chrono::steady_clock::now();
+    benchmark.Run(std::chrono::microseconds(100));
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+  }
+
+  SECTION("Time budget of a microsecond benchmark") {
+    // Hundreds of thousands of samples, the stopping checks must not exceed the budget
+    JitterBenchmark jitter;
+    jitter.Configure(1000, 100);
+    jitter.ConfigureAdaptive(0, 1, 1e-9);
+    const auto start = std::chrono::steady_clock::now();
+    const auto stats = jitter.Run(std::chrono::microseconds(1));
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    REQUIRE(stats.count > 10000);
+    REQUIRE(elapsed.count() > 0.5);
+    REQUIRE(elapsed.count() < 1.5);
+  }
+}
+
+/**
+ * End doxygen group framework.
+ * @}
+ */
@@ -0,0 +1,177 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+#include <hip_test_common.hh>
+#include <performance_comparison.hh>
+
+/**
+ * @addtogroup framework framework
+ * @{
+ * @ingroup PerformanceTest
+ */
+
+static std::vector<int64_t> NormalSamples(double mean, double deviation, size_t count,
+                                          unsigned seed) {
+  std::mt19937 generator(seed);
+  std::normal_distribution<double> distribution(mean, deviation);
+  std::vector<int64_t> samples(count);
+  for (auto& sample : samples) sample = std::llround(distribution(generator));
+  return samples;
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Checks the Mann-Whitney U p-value against known values and for degenerate inputs.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkComparison.cc
+ */
+TEST_CASE("Unit_BenchmarkComparison_MannWhitneyU") {
+  SECTION("Identical constant samples") {
+    std::vector<int64_t> a(20, 1000);
+    REQUIRE(MannWhitneyU(a, a) == 1.0);
+  }
+
+  SECTION("Empty samples") { REQUIRE(MannWhitneyU({}, {1000, 2000}) == 1.0); }
+
+  SECTION("Fully separated samples") {
+    std::vector<int64_t> a{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    std::vector<int64_t> b{11, 12, 13, 14, 15, 16, 17, 18, 19, 20};
+    // U = 0, z = (50 - 0.5) / sqrt(175)
+    REQUIRE(MannWhitneyU(a, b) == Approx(std::erfc(49.5 / std::sqrt(175.0) / std::sqrt(2.0))));
+    REQUIRE(MannWhitneyU(a, b) == Approx(MannWhitneyU(b, a)));
+  }
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Classifies synthetic sample sets as improved, unchanged or regressed.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkComparison.cc
+ */
+TEST_CASE("Unit_BenchmarkComparison_Verdict") {
+  const auto baseline = NormalSamples(1e6, 5e4, 500, 1);
+
+  SECTION("Same distribution") {
+    auto comparison = CompareSamples(baseline, NormalSamples(1e6, 5e4, 500, 2));
+    REQUIRE(comparison.verdict == BenchmarkVerdict::kUnchanged);
+  }
+
+  SECTION("Slower") {
+    auto comparison = CompareSamples(baseline, NormalSamples(1.2e6, 5e4, 500, 2));
+    REQUIRE(comparison.verdict == BenchmarkVerdict::kRegressed);
+    REQUIRE(comparison.relative_change == Approx(0.2).margin(0.02));
+  }
+
+  SECTION("Faster") {
+    auto comparison = CompareSamples(baseline, NormalSamples(0.8e6, 5e4, 500, 2));
+    REQUIRE(comparison.verdict == BenchmarkVerdict::kImproved);
+  }
+
+  SECTION("Significant but below threshold") {
+    auto comparison = CompareSamples(baseline, NormalSamples(1.02e6, 5e4, 500, 2));
+    REQUIRE(comparison.p_value < 0.05);
+    REQUIRE(comparison.verdict == BenchmarkVerdict::kUnchanged);
+  }
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Writes results with the JSON Lines and CSV sinks and reads them back.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkComparison.cc
+ */
+TEST_CASE("Unit_BenchmarkComparison_LoadResults") {
+  const std::string path = GENERATE(std::string("benchmark_results.jsonl"),
+                                    std::string("benchmark_results.csv"));
+  std::remove(path.c_str());
+
+  BenchmarkResult result;
+  result.name = "Performance_Test/\"quoted\", section/10/1";
+  result.iterations = 10;
+  result.warmups = 1;
+  result.samples = {1500, 2250, 3125};
+  result.stats = ComputeStatistics(result.samples);
+  result.device_name = "device";
+  result.git_hash = "abcdef";
+  {
+    auto sink = CreateResultSink(path);
+    sink->Write(result);
+    result.iterations = 20;
+    sink->Write(result);
+  }
+
+  std::map<std::string, BenchmarkResult> results;
+  REQUIRE(LoadBenchmarkResults(path, results));
+  std::remove(path.c_str());
+
+  REQUIRE(results.size() == 1);
+  const auto& loaded = results.at(result.name);
+  REQUIRE(loaded.iterations == 20);
+  REQUIRE(loaded.warmups == 1);
+  REQUIRE(loaded.samples == result.samples);
+  REQUIRE(loaded.device_name == result.device_name);
+  REQUIRE(loaded.git_hash == result.git_hash);
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Loads CSV records with empty or non-numeric numeric fields and checks that loading fails
+ *    instead of throwing.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkComparison.cc
+ */
+TEST_CASE("Unit_BenchmarkComparison_LoadMalformedCsv") {
+  const std::string record = GENERATE(std::string("Test,,1,0,1 2"), std::string("Test,x,1,0,1 2"),
+                                      std::string("Test,10,1x,0,1 2"),
+                                      std::string("Test,10,1,,1 2"),
+                                      std::string("Test,10,1,99999999999,1 2"),
+                                      std::string("Test,10,1,0,1 a"));
+  const std::string path = "benchmark_malformed.csv";
+  {
+    std::ofstream out(path);
+    out << "name,iterations,warmups,runtime_version,samples_ns\n" << record << "\n";
+  }
+
+  std::map<std::string, BenchmarkResult> results;
+  INFO("Record: " << record);
+  bool loaded = true;
+  REQUIRE_NOTHROW(loaded = LoadBenchmarkResults(path, results));
+  std::remove(path.c_str());
+  REQUIRE_FALSE(loaded);
+}
+
+/**
+ * End doxygen group framework.
+ * @}
+ */
@@ -0,0 +1,104 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <performance_common.hh>
+#include <performance_counters.hh>
+
+/**
+ * @addtogroup framework framework
+ * @{
+ * @ingroup PerformanceTest
+ */
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Opens the perf counters of the calling thread and checks that available counters advance,
+ *    unavailable counters read as zero.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkCounters.cc
+ */
+TEST_CASE("Unit_Benchmark_PerfCounters") {
+  PerfCounters counters;
+  if (!counters.AnyAvailable()) {
+    WARN("perf_event_open is not available, counters are reported as unavailable");
+  }
+
+  PerfCounterValues before, after;
+  counters.Read(before);
+  volatile double sum = 0;
+  for (int i = 0; i < 1000000; ++i) sum = sum + i;
+  counters.Read(after);
+
+  for (size_t i = 0; i < kPerfCounterCount; ++i) {
+    const auto counter = static_cast<PerfCounter>(i);
+    INFO(GetPerfCounterName(counter));
+    REQUIRE(after[i] >= before[i]);
+    if (!counters.Available(counter)) REQUIRE(after[i] == 0);
+  }
+  if (counters.Available(PerfCounter::kInstructions)) {
+    REQUIRE(after[1] - before[1] >= 1000000);
+  }
+}
+
+class CountedBenchmark : public Benchmark<CountedBenchmark> {
+ public:
+  void operator()() {
+    TIMED_SECTION(kTimerTypeCpu) {
+      volatile double sum = 0;
+      for (int i = 0; i < 10000; ++i) sum = sum + i;
+    }
+  }
+};
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Runs a host only benchmark with perf counters enabled and checks the reported averages.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkCounters.cc
+ */
+TEST_CASE("Unit_Benchmark_PerfCountersAverages") {
+  CountedBenchmark benchmark;
+  benchmark.Configure(20, 2);
+  benchmark.ConfigureAdaptive(0, 0, 0);
+  benchmark.EnablePerfCounters(true);
+  benchmark.Run();
+
+  const PerfCounters counters;
+  const auto& averages = benchmark.perf_counter_averages();
+  for (size_t i = 0; i < kPerfCounterCount; ++i) {
+    const auto counter = static_cast<PerfCounter>(i);
+    REQUIRE(averages.count(GetPerfCounterName(counter)) == counters.Available(counter));
+  }
+  if (auto it = averages.find("instructions"); it != averages.end()) {
+    REQUIRE(it->second >= 10000);
+  }
+}
+
+/**
+ * End doxygen group framework.
+ * @}
+ */
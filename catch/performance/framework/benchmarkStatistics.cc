@@ -0,0 +1,177 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <performance_statistics.hh>
+
+#include <numeric>
+#include <random>
+
+/**
+ * @addtogroup framework framework
+ * @{
+ * @ingroup PerformanceTest
+ */
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Checks percentiles, median and median absolute deviation of small known sample sets.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkStatistics.cc
+ */
+TEST_CASE("Unit_BenchmarkStatistics_Percentiles") {
+  const std::vector<int64_t> sorted{1, 2, 3, 4, 5};
+  REQUIRE(Percentile(sorted, 0) == 1);
+  REQUIRE(Percentile(sorted, 25) == 2);
+  REQUIRE(Percentile(sorted, 50) == 3);
+  REQUIRE(Percentile(sorted, 90) == Approx(4.6));
+  REQUIRE(Percentile(sorted, 100) == 5);
+  REQUIRE(Percentile(std::vector<int64_t>{}, 50) == 0);
+
+  REQUIRE(Median(std::vector<int64_t>{4, 1, 3, 2}) == Approx(2.5));
+
+  const std::vector<int64_t> samples{1, 1, 2, 2, 4, 6, 9};
+  REQUIRE(MedianAbsoluteDeviation(samples, Median(samples)) == 1);
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Flags samples far away from the median as outliers and optionally excludes them from the
+ *    mean, deviation and extremes.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkStatistics.cc
+ */
+TEST_CASE("Unit_BenchmarkStatistics_Outliers") {
+  std::vector<int64_t> samples;
+  for (int i = 0; i < 100; ++i) samples.push_back(1000 + i % 10);
+  samples.push_back(100000);  // e.g. a preempted iteration
+
+  const auto outliers = FlagOutliers(samples);
+  REQUIRE(std::count(outliers.begin(), outliers.end(), true) == 1);
+  REQUIRE(outliers.back());
+
+  SECTION("Constant samples") {
+    const auto constant = FlagOutliers(std::vector<int64_t>(10, 5));
+    REQUIRE(std::count(constant.begin(), constant.end(), true) == 0);
+  }
+
+  SECTION("Kept") {
+    const auto stats = ComputeStatistics(samples);
+    REQUIRE(stats.outliers == 1);
+    REQUIRE_FALSE(stats.outliers_rejected);
+    REQUIRE(stats.max == 100000);
+    REQUIRE(stats.mean > 1900);
+  }
+
+  SECTION("Rejected") {
+    const auto stats = ComputeStatistics(samples, true);
+    REQUIRE(stats.outliers_rejected);
+    REQUIRE(stats.max == 1009);
+    REQUIRE(stats.mean == Approx(1004.5));
+    REQUIRE(stats.percentiles.at(99.9) > 1009);  // Tails still use every sample
+  }
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Checks that the confidence intervals are reproducible and contain the estimate, that the
+ *    median interval uses the binomial order statistics and the mean interval the normal
+ *    approximation, also for a large sample set.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkStatistics.cc
+ */
+TEST_CASE("Unit_BenchmarkStatistics_ConfidenceInterval") {
+  std::vector<int64_t> samples;
+  for (int i = 0; i < 1000; ++i) samples.push_back(1000 + (i * 7919) % 200);
+
+  const auto stats = ComputeStatistics(samples);
+  REQUIRE(stats.count == samples.size());
+  REQUIRE(stats.median_ci.low <= stats.median);
+  REQUIRE(stats.median_ci.high >= stats.median);
+  REQUIRE(stats.mean_ci.low <= stats.mean);
+  REQUIRE(stats.mean_ci.high >= stats.mean);
+  REQUIRE(stats.median_ci.high - stats.median_ci.low < 40);
+
+  const auto again = ComputeStatistics(samples);
+  REQUIRE(again.median_ci.low == stats.median_ci.low);
+  REQUIRE(again.median_ci.high == stats.median_ci.high);
+
+  REQUIRE(NormalCriticalValue(0.95) == Approx(1.959964).epsilon(1e-6));
+  std::vector<int64_t> ranks(1000);
+  std::iota(ranks.begin(), ranks.end(), 1);
+  const auto ranked = ComputeStatistics(ranks);
+  REQUIRE(ranked.median_ci.low == 469);  // floor(500 - 1.96 * sqrt(1000) / 2)
+  REQUIRE(ranked.median_ci.high == 532);  // ceil(501 + 1.96 * sqrt(1000) / 2)
+  const double spread = 1.959964 * ranked.deviation / std::sqrt(1000.0);
+  REQUIRE(ranked.mean_ci.low == Approx(ranked.mean - spread));
+  REQUIRE(ranked.mean_ci.high == Approx(ranked.mean + spread));
+
+  std::vector<int64_t> large(1000000);
+  std::mt19937_64 generator(7);
+  std::uniform_int_distribution<int64_t> distribution(1000, 2000);
+  for (auto& sample : large) sample = distribution(generator);
+  const auto large_stats = ComputeStatistics(large);
+  REQUIRE(large_stats.median_ci.low <= large_stats.median);
+  REQUIRE(large_stats.median_ci.high >= large_stats.median);
+
+  const auto empty = ComputeStatistics({});
+  REQUIRE(empty.count == 0);
+  REQUIRE(empty.median == 0);
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Derives bandwidth, item rate and percentage of the peak bandwidth from the work done per
+ *    iteration and the iteration time.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkStatistics.cc
+ */
+TEST_CASE("Unit_BenchmarkStatistics_Throughput") {
+  // 4 MiB and 1024 items in 2 ms
+  const auto throughput = ComputeThroughput(2e6, 4 << 20, 1024, 100);
+  REQUIRE(throughput.bytes_per_iteration == 4 << 20);
+  REQUIRE(throughput.items_per_iteration == 1024);
+  REQUIRE(throughput.gb_per_s == Approx(2.097152));
+  REQUIRE(throughput.gib_per_s == Approx(1.953125));
+  REQUIRE(throughput.items_per_s == Approx(512000));
+  REQUIRE(throughput.percent_of_peak == Approx(2.097152));
+
+  const auto unknown_peak = ComputeThroughput(2e6, 4 << 20, 0);
+  REQUIRE(unknown_peak.items_per_s == 0);
+  REQUIRE(unknown_peak.percent_of_peak == 0);
+
+  const auto no_time = ComputeThroughput(0, 4 << 20, 1024, 100);
+  REQUIRE(no_time.gb_per_s == 0);
+}
+
+/**
+ * End doxygen group framework.
+ * @}
+ */
@@ -0,0 +1,100 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <performance_common.hh>
+
+/**
+ * @addtogroup framework framework
+ * @{
+ * @ingroup PerformanceTest
+ */
+
+class NoopBenchmark : public Benchmark<NoopBenchmark> {
+ public:
+  void operator()() {
+    TIMED_SECTION(kTimerTypeCpu) {}
+  }
+};
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Runs a host only benchmark for every point of a sweep over sizes, allocation types and
+ *    stream types and checks the order, naming and filtering of the resulting table.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkSweep.cc
+ */
+TEST_CASE("Unit_Benchmark_Sweep") {
+  REQUIRE(GetSweepValueName(4_KB) == "4 KB");
+  REQUIRE(GetSweepValueName(64_MB) == "64 MB");
+  REQUIRE(GetSweepValueName(2_GB) == "2 GB");
+  REQUIRE(GetSweepValueName(size_t{1000}) == "1000 B");
+  REQUIRE(GetSweepValueName(LinearAllocs::hipMalloc) == "device malloc");
+  REQUIRE(GetSweepValueName(Streams::created) == "created stream");
+  REQUIRE(GetSweepValueName(3) == "3");
+
+  Sweep sweep(Axis("size", {4_KB, 1_MB}),
+              Axis("alloc", {LinearAllocs::hipHostMalloc, LinearAllocs::hipMalloc}),
+              Axis("stream", {Streams::nullstream, Streams::created}));
+  auto run = [](NoopBenchmark& benchmark, size_t size, LinearAllocs, Streams) {
+    benchmark.Configure(10, 1);
+    benchmark.SetBytesProcessed(size);
+    return benchmark.Run();
+  };
+
+  SECTION("Cartesian product") {
+    sweep.SetFilter(SweepFilter());  // Ignore --benchmark-sweep-filter
+    const auto table = sweep.Run<NoopBenchmark>(run);
+    REQUIRE(table.axes == std::vector<std::string>{"size", "alloc", "stream"});
+    REQUIRE(table.rows.size() == 8);
+    REQUIRE(table.rows.front().values ==
+            std::vector<std::string>{"4 KB", "host pinned", "null stream"});
+    REQUIRE(table.rows.back().values ==
+            std::vector<std::string>{"1 MB", "device malloc", "created stream"});
+    for (const auto& row : table.rows) {
+      REQUIRE(row.stats.count == 10);
+      REQUIRE(row.throughput.bytes_per_iteration == (row.values[0] == "4 KB" ? 4_KB : 1_MB));
+    }
+
+    std::ostringstream out;
+    table.Print(out);
+    REQUIRE(out.str().find("median (ms)") != std::string::npos);
+    REQUIRE(out.str().find("GB/s") != std::string::npos);
+  }
+
+  SECTION("Filter") {
+    sweep.SetFilter(SweepFilter("size=1 MB;stream=created stream|per thread stream;unknown=x"));
+    const auto table = sweep.Run<NoopBenchmark>(run);
+    REQUIRE(table.rows.size() == 2);
+    for (const auto& row : table.rows) {
+      REQUIRE(row.values[0] == "1 MB");
+      REQUIRE(row.values[2] == "created stream");
+    }
+  }
+}
+
+/**
+ * End doxygen group framework.
+ * @}
+ */
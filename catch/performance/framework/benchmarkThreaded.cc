@@ -0,0 +1,94 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <performance_common.hh>
+
+/**
+ * @addtogroup framework framework
+ * @{
+ * @ingroup PerformanceTest
+ */
+
+class ThreadedSpinBenchmark : public Benchmark<ThreadedSpinBenchmark> {
+ public:
+  void operator()(std::chrono::microseconds duration) {
+    threads_seen |= 1u << thread_index();
+    TIMED_SECTION_STREAM(kTimerTypeCpu, stream()) {
+      const auto end = std::chrono::steady_clock::now() + duration;
+      while (std::chrono::steady_clock::now() < end) {
+      }
+    }
+  }
+
+  std::atomic<unsigned> threads_seen{0};
+};
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Runs a host only benchmark on several threads and checks the per thread and aggregate
+ *    statistics, also as part of a sweep over the number of threads.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkThreaded.cc
+ */
+TEST_CASE("Unit_Benchmark_RunThreaded") {
+  SECTION("Aggregate") {
+    ThreadedSpinBenchmark benchmark;
+    benchmark.Configure(50, 5);
+    benchmark.SetItemsProcessed(1);
+    const auto result = benchmark.RunThreaded(4, std::chrono::microseconds(20));
+
+    REQUIRE(benchmark.threads_seen == 0xf);
+    REQUIRE(result.threads.size() == 4);
+    for (const auto& thread : result.threads) {
+      REQUIRE(thread.stats.count == 50);
+      REQUIRE(thread.stats.min >= 20000);
+      REQUIRE(thread.iterations_per_s > 0);
+      REQUIRE(thread.iterations_per_s < 1e6 / 20);
+    }
+    REQUIRE(result.stats.count == 200);
+    REQUIRE(result.iterations_per_s > result.threads.front().iterations_per_s / 4);
+    REQUIRE(result.throughput.items_per_s == Approx(result.iterations_per_s));
+  }
+
+  SECTION("Sweep") {
+    Sweep sweep(Axis("threads", {1, 2, 4}));
+    sweep.SetFilter(SweepFilter());
+    const auto table =
+        sweep.Run<ThreadedSpinBenchmark>([](ThreadedSpinBenchmark& benchmark, int threads) {
+          benchmark.Configure(20, 2);
+          benchmark.SetItemsProcessed(1);
+          return benchmark.RunThreaded(threads, std::chrono::microseconds(10));
+        });
+    REQUIRE(table.rows.size() == 3);
+    REQUIRE(table.rows.back().values.front() == "4");
+    REQUIRE(table.rows.back().stats.count == 4 * 20);
+    REQUIRE(table.rows.back().throughput.items_per_s > 0);
+  }
+}
+
+/**
+ * End doxygen group framework.
+ * @}
+ */
@@ -0,0 +1,129 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <performance_common.hh>
+
+/**
+ * @addtogroup framework framework
+ * @{
+ * @ingroup PerformanceTest
+ */
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Checks that the event pool hands out reserved events and recycles released ones per stream.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkTimers.cc
+ */
+TEST_CASE("Unit_Benchmark_EventPool") {
+  StreamGuard stream(Streams::created);
+  EventPool pool;
+  pool.Reserve(nullptr, 2);
+
+  const auto first = pool.Acquire(nullptr);
+  const auto second = pool.Acquire(nullptr);
+  REQUIRE(first != second);
+
+  pool.Release(nullptr, first);
+  REQUIRE(pool.Acquire(nullptr) == first);
+
+  const auto other = pool.Acquire(stream.stream());
+  pool.Release(stream.stream(), other);
+  REQUIRE(pool.Acquire(stream.stream()) == other);
+}
+
+class CountingBenchmark : public Benchmark<CountingBenchmark> {
+ public:
+  void operator()(std::chrono::microseconds duration) {
+    ++calls;
+    TIMED_SECTION(kTimerTypeCpu) {
+      const auto end = std::chrono::steady_clock::now() + duration;
+      while (std::chrono::steady_clock::now() < end) {
+      }
+    }
+  }
+
+  size_t calls = 0;
+};
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Runs a host only benchmark in batched mode and checks that every sample is the average of a
+ *    batch of calls.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkTimers.cc
+ */
+TEST_CASE("Unit_Benchmark_Batch") {
+  CountingBenchmark benchmark;
+  benchmark.Configure(20, 2);
+  benchmark.ConfigureAdaptive(0, 0, 0);
+  benchmark.ConfigureBatch(10);
+  REQUIRE(benchmark.batch_size() == 10);
+
+  const auto stats = benchmark.Run(std::chrono::microseconds(10));
+  REQUIRE(benchmark.calls == (20 + 2) * 10);
+  REQUIRE(stats.count == 20);
+  REQUIRE(stats.min >= 10000);
+  REQUIRE(stats.median < 100000);
+}
+
+class EmptyBenchmark : public Benchmark<EmptyBenchmark> {
+ public:
+  void operator()() {
+    TIMED_SECTION(kTimerTypeCpu) {}
+  }
+};
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Calibrates the overhead of the timers and checks that subtracting it from an empty timed
+ *    section leaves close to nothing.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkTimers.cc
+ */
+TEST_CASE("Unit_Benchmark_TimerOverhead") {
+  EmptyBenchmark benchmark;
+  benchmark.Configure(100, 10);
+  benchmark.ConfigureAdaptive(0, 0, 0);
+
+  const auto overhead = benchmark.TimerOverhead<kTimerTypeCpu>();
+  REQUIRE(overhead >= 0);
+  REQUIRE(benchmark.TimerOverhead<kTimerTypeCpu>() == overhead);  // Calibrated once
+  REQUIRE(benchmark.TimerOverhead<kTimerTypeEvent>() >= 0);
+
+  benchmark.SubtractTimerOverhead(true);
+  const auto stats = benchmark.Run();
+  REQUIRE(stats.min >= 0);
+  REQUIRE(stats.median <= overhead);
+}
+
+/**
+ * End doxygen group framework.
+ * @}
+ */
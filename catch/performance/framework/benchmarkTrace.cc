@@ -0,0 +1,88 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <performance_trace.hh>
+#include <picojson.h>
+
+#include <fstream>
+#include <sstream>
+
+/**
+ * @addtogroup framework framework
+ * @{
+ * @ingroup PerformanceTest
+ */
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Records host thread and stream events into a small ring buffer, checks that the oldest
+ *    events are dropped once it is full and that the written trace is valid JSON.
+ * Test source
+ * ------------------------
+ *  - performance/framework/benchmarkTrace.cc
+ */
+TEST_CASE("Unit_Benchmark_TraceRecorder") {
+  TraceRecorder recorder(4);
+  const char* name = recorder.Intern("Benchmark \"quoted\"");
+  REQUIRE(recorder.Intern("Benchmark \"quoted\"") == name);
+
+  for (int i = 0; i < 6; ++i) {
+    recorder.RecordThreadEvent(name, "iteration", i * 1000, i * 1000 + 500, "iteration", i);
+  }
+  recorder.RecordStreamEvent("TIMED_SECTION", "event timer", 0, 100, nullptr);
+  REQUIRE(recorder.size() == 4);
+  REQUIRE(recorder.dropped() == 3);
+
+  const std::string path = "trace_recorder_test.json";
+  REQUIRE(recorder.Write(path));
+  std::ifstream in(path);
+  std::stringstream json;
+  json << in.rdbuf();
+  in.close();
+  std::remove(path.c_str());
+
+  picojson::value trace;
+  REQUIRE(picojson::parse(trace, json.str()).empty());
+  const auto& events = trace.get("traceEvents").get<picojson::array>();
+  size_t iterations = 0, streams = 0;
+  for (const auto& event : events) {
+    if (event.get("ph").get<std::string>() != "X") continue;
+    if (event.get("cat").get<std::string>() == "iteration") {
+      ++iterations;
+      REQUIRE(event.get("name").get<std::string>() == "Benchmark \"quoted\"");
+      REQUIRE(event.get("args").get("iteration").get<double>() >= 3);
+      REQUIRE(event.get("dur").get<double>() == Approx(0.5));
+    } else {
+      ++streams;
+      REQUIRE(event.get("pid").get<double>() == 2);
+    }
+  }
+  REQUIRE(iterations == 3);
+  REQUIRE(streams == 1);
+}
+
+/**
+ * End doxygen group framework.
+ * @}
+ */
@@ -0,0 +1,118 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+/*
+ * Compares two result files written with --benchmark-out and reports, for every benchmark present
+ * in both, whether it improved, regressed or stayed unchanged.
+ *
+ * Usage: benchmark_compare <baseline> <current> [--threshold <ratio>] [--alpha <p-value>]
+ *
+ * The exit code is 1 if any benchmark regressed, 2 on invalid input and 0 otherwise.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include <performance_comparison.hh>
+
+static void PrintUsage(const char* exe) {
+  std::cerr << "Usage: " << exe
+            << " <baseline> <current> [--threshold <ratio>] [--alpha <p-value>]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  std::string baseline_path, current_path;
+  ComparisonCriteria criteria;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--threshold" && i + 1 < argc) {
+      criteria.threshold = std::atof(argv[++i]);
+    } else if (arg == "--alpha" && i + 1 < argc) {
+      criteria.alpha = std::atof(argv[++i]);
+    } else if (baseline_path.empty()) {
+      baseline_path = arg;
+    } else if (current_path.empty()) {
+      current_path = arg;
+    } else {
+      PrintUsage(argv[0]);
+      return 2;
+    }
+  }
+  if (current_path.empty()) {
+    PrintUsage(argv[0]);
+    return 2;
+  }
+
+  std::map<std::string, BenchmarkResult> baseline, current;
+  if (!LoadBenchmarkResults(baseline_path, baseline)) {
+    std::cerr << "Unable to load " << baseline_path << std::endl;
+    return 2;
+  }
+  if (!LoadBenchmarkResults(current_path, current)) {
+    std::cerr << "Unable to load " << current_path << std::endl;
+    return 2;
+  }
+
+  size_t regressed = 0, improved = 0, unchanged = 0;
+  std::cout << std::left << std::setw(80) << "Benchmark" << std::right << std::setw(14)
+            << "Baseline[ms]" << std::setw(14) << "Current[ms]" << std::setw(10) << "Change"
+            << std::setw(12) << "p-value" << "  Verdict" << std::endl;
+  for (const auto& [name, result] : current) {
+    auto it = baseline.find(name);
+    if (it == baseline.end()) {
+      std::cout << std::left << std::setw(80) << name << "  missing in baseline" << std::endl;
+      continue;
+    }
+
+    auto comparison = CompareSamples(it->second.samples, result.samples, criteria);
+    switch (comparison.verdict) {
+      case BenchmarkVerdict::kRegressed:
+        ++regressed;
+        break;
+      case BenchmarkVerdict::kImproved:
+        ++improved;
+        break;
+      default:
+        ++unchanged;
+    }
+    std::cout << std::left << std::setw(80) << name << std::right << std::fixed
+              << std::setprecision(6) << std::setw(14) << comparison.baseline_median * 1e-6
+              << std::setw(14) << comparison.current_median * 1e-6 << std::setprecision(2)
+              << std::setw(9) << 100 * comparison.relative_change << "%" << std::scientific
+              << std::setw(12) << comparison.p_value << "  " << GetVerdictName(comparison.verdict)
+              << std::defaultfloat << std::endl;
+  }
+  for (const auto& [name, result] : baseline) {
+    if (current.find(name) == current.end()) {
+      std::cout << std::left << std::setw(80) << name << "  missing in current" << std::endl;
+    }
+  }
+
+  std::cout << "\n"
+            << improved << " improved, " << unchanged << " unchanged, " << regressed
+            << " regressed" << std::endl;
+  return regressed ? 1 : 0;
+}
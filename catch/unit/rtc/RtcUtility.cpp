@@ -40,8 +40,9 @@ which has to be called with a set of required parameters
 (combination of compiler options is one among them). this function returns
 the status of execution ie 1 or 0 (bool).
 
-4) getblock_fromconfig() : This function is used to open the RtcConfig.json
-file and return the blocks.
+4) getblock_fromconfig() : This function parses the RtcConfig.json file once
+and returns the blocks. get_config_block() looks a block up by its name in a
+table built once from them.
 
 5) get_string_parameters() and get_array_parameters() : retrieved the
 parameters of the respective block name.
@@ -51,6 +52,8 @@ parameters of the respective block name.
 #include <hip/hiprtc.h>
 #include <hip/hip_runtime.h>
 #include <picojson.h>
+#include <algorithm>
+#include <map>
 #include <vector>
 #include <string>
 #include <fstream>
@@ -59,6 +62,7 @@ parameters of the respective block name.
 #include "headers/RtcFunctions.h"
 #include "headers/RtcKernels.h"
 #include <hip_test_common.hh>
+#include <hip_test_filesystem.hh>
 #include "headers/printf_common.h"
 
 #pragma clang diagnostic ignored "-Wunused-but-set-variable"
@@ -113,16 +117,7 @@ int calling_combination_function(std::vector<std::string> combi_vec_list) {
     } else if (combi_vec_list[i] == "header_dir") {
       std::string retrived_CO = get_string_parameters("compiler_option",
                                                       "header_dir");
-      std::string str = "pwd";
-      const char *cmd = str.c_str();
-      CaptureStream capture(stdout);
-      capture.Begin();
-      system(cmd);
-      capture.End();
-      std::string wor_dir = capture.getData();
-      std::string break_dir = wor_dir.substr(0, wor_dir.find("build"));
-      std::string append_str = "catch/unit/rtc/headers";
-      std::string CO = retrived_CO + " " + break_dir + append_str;
+      std::string CO = retrived_CO + " " + get_rtc_source_dir() + "headers";
       hold_CO[i] = CO;
     } else if (combi_vec_list[i] == "architecture") {
       std::string retrived_CO = get_string_parameters("compiler_option",
@@ -377,132 +372,84 @@ bool  calling_resp_function(const std::string block_name,
   }
 }
 
-picojson::array getblock_fromconfig() {
-  std::string str = "pwd";
-  const char *cmd = str.c_str();
-  CaptureStream capture(stdout);
-  capture.Begin();
-  system(cmd);
-  capture.End();
-  std::string wor_dir = capture.getData();
-  std::string break_dir = wor_dir.substr(0, wor_dir.find("build"));
-  std::string append_str = "catch/unit/rtc/RtcConfig.json";
-  std::string config_path = break_dir + append_str;
-  std::string returnValue = "";
-  std::ifstream json_file(config_path.c_str());
-  if (!json_file.is_open()) {
-    WARN("Error loading config.jason");
-    exit(0);
-  }
-  std::string json_str((std::istreambuf_iterator<char>(json_file)),
-                        std::istreambuf_iterator<char>());
-  picojson::value v;
-  std::string err = picojson::parse(v, json_str);
-  if (!err.empty()) {
-    WARN("empty config.jason");
-    exit(0);
-  }
-  picojson::array& blocks = v.get<picojson::array>();
+std::string get_rtc_source_dir() {
+  static const std::string source_dir = []() {
+    // The tests run from the build tree, next to the source tree
+    std::string wor_dir = fs::current_path().string();
+    std::string break_dir = wor_dir.substr(0, wor_dir.find("build"));
+    return break_dir + "catch/unit/rtc/";
+  }();
+  return source_dir;
+}
+
+const picojson::array& getblock_fromconfig() {
+  // Parsed once, all lookups of the test cases and combinations share it
+  static const picojson::array blocks = []() {
+    std::string config_path = get_rtc_source_dir() + "RtcConfig.json";
+    std::ifstream json_file(config_path.c_str());
+    if (!json_file.is_open()) {
+      WARN("Error loading config.jason");
+      exit(0);
+    }
+    std::string json_str((std::istreambuf_iterator<char>(json_file)),
+                          std::istreambuf_iterator<char>());
+    picojson::value v;
+    std::string err = picojson::parse(v, json_str);
+    if (!err.empty()) {
+      WARN("empty config.jason");
+      exit(0);
+    }
+    return v.get<picojson::array>();
+  }();
   return blocks;
 }
 
+const picojson::object* get_config_block(const std::string& block_name) {
+  static const std::map<std::string, const picojson::object*> table = []() {
+    std::map<std::string, const picojson::object*> blocks;
+    for (const picojson::value& block : getblock_fromconfig()) {
+      const picojson::object& block_obj = block.get<picojson::object>();
+      blocks.emplace(block_obj.at("block_name").get<std::string>(),
+                     &block_obj);
+    }
+    return blocks;
+  }();
+  auto it = table.find(block_name);
+  return it == table.end() ? nullptr : it->second;
+}
+
 std::string get_string_parameters(std::string para_name_to_retrieve,
                                   std::string block_name) {
-  std::string returnValue = "";
-  picojson::array blocks = getblock_fromconfig();
-  for (picojson::value& block : blocks) {
-    picojson::object& block_obj = block.get<picojson::object>();
-    std::string blk_name = block_obj.at("block_name").get<std::string>();
-    if (blk_name == block_name) {
-      if (para_name_to_retrieve == "compiler_option") {
-        std::string compiler_opt =
-                            block_obj.at("compiler_option").get<std::string>();
-        returnValue += compiler_opt;
-      } else if (para_name_to_retrieve == "Target_Vals") {
-        std::string Target_Vals =
-                                block_obj.at("Target_Vals").get<std::string>();
-        returnValue += Target_Vals;
-      } else if (para_name_to_retrieve == "kernel_name") {
-        std::string ker_name = block_obj.at("kernel_name").get<std::string>();
-        returnValue += ker_name;
-      } else if (para_name_to_retrieve == "reverse_compiler_option") {
-        std::string reverse =
-                    block_obj.at("reverse_compiler_option").get<std::string>();
-        returnValue += reverse;
-      } else if (para_name_to_retrieve == "ready_compiler_option") {
-        std::string ready_CO =
-                      block_obj.at("ready_compiler_option").get<std::string>();
-        returnValue += ready_CO;
-      } else {
-        WARN("REQUESTED FIELD not present : " << para_name_to_retrieve);
-      }
-    } else {
-      continue;
-    }
+  static const std::vector<std::string> string_parameters = {
+      "compiler_option", "Target_Vals", "kernel_name",
+      "reverse_compiler_option", "ready_compiler_option"};
+  const picojson::object* block_obj = get_config_block(block_name);
+  if (block_obj == nullptr) {
+    return "";
+  }
+  if (std::find(string_parameters.begin(), string_parameters.end(),
+                para_name_to_retrieve) == string_parameters.end()) {
+    WARN("REQUESTED FIELD not present : " << para_name_to_retrieve);
+    return "";
   }
-  return returnValue;
+  return block_obj->at(para_name_to_retrieve).get<std::string>();
 }
 
 picojson::array get_array_parameters(std::string para_name_to_retrieve,
                                      std::string block_name) {
-  std::string returnValue = "";
-  picojson::array blocks = getblock_fromconfig();
-  for (picojson::value& block : blocks) {
-    picojson::object& block_obj = block.get<picojson::object>();
-    std::string blk_name = block_obj.at("block_name").get<std::string>();
-    if (blk_name == block_name) {
-      if (para_name_to_retrieve == "Target_Vals") {
-        picojson::array& Target_Vals =
-                    block_obj.at("Target_Vals").get<picojson::array>();
-        return Target_Vals;
-      } else if (para_name_to_retrieve == "single_CO") {
-        picojson::array& single_CO =
-                         block_obj.at("single_CO").get<picojson::array>();
-        return single_CO;
-      } else if (para_name_to_retrieve == "Combi_CO") {
-        picojson::array& Combi_CO =
-                         block_obj.at("Combi_CO").get<picojson::array>();
-        return Combi_CO;
-      } else if (para_name_to_retrieve == "Input_Vals") {
-        picojson::array& Input_Vals =
-                         block_obj.at("Input_Vals").get<picojson::array>();
-        return Input_Vals;
-      } else if (para_name_to_retrieve == "Expected_Results") {
-        picojson::array& Expected =
-                     block_obj.at("Expected_Results").get<picojson::array>();
-        return Expected;
-      } else if (para_name_to_retrieve == "Expected_Results_for_no") {
-        picojson::array& Expected_for_no =
-                block_obj.at("Expected_Results_for_no").get<picojson::array>();
-        return Expected_for_no;
-      } else if (para_name_to_retrieve == "compiler_option") {
-        picojson::array& compiler_option =
-                       block_obj.at("compiler_option").get<picojson::array>();
-        return compiler_option;
-      } else if (para_name_to_retrieve == "reverse_compiler_option") {
-        picojson::array& reverse_compiler_option =
-                block_obj.at("reverse_compiler_option").get<picojson::array>();
-        return reverse_compiler_option;
-      } else if (para_name_to_retrieve == "Headers") {
-        picojson::array& Headers =
-                         block_obj.at("Headers").get<picojson::array>();
-        return Headers;
-      } else if (para_name_to_retrieve == "Src_headers") {
-        picojson::array& Src_headers =
-                         block_obj.at("Src_headers").get<picojson::array>();
-        return Src_headers;
-      } else if (para_name_to_retrieve == "depending_comp_optn") {
-        picojson::array& depending_comp_optn =
-                 block_obj.at("depending_comp_optn").get<picojson::array>();
-        return depending_comp_optn;
-      } else {
-        WARN("REQUESTED FIELD not present : " << para_name_to_retrieve);
-        return picojson::array();
-      }
-    } else {
-      continue;
-    }
+  static const std::vector<std::string> array_parameters = {
+      "Target_Vals", "single_CO", "Combi_CO", "Input_Vals", "Expected_Results",
+      "Expected_Results_for_no", "compiler_option", "reverse_compiler_option",
+      "Headers", "Src_headers", "depending_comp_optn"};
+  const picojson::object* block_obj = get_config_block(block_name);
+  if (block_obj == nullptr) {
+    WARN("REQUESTED BLOCK " << block_name << " is not present ");
+    return picojson::array();
+  }
+  if (std::find(array_parameters.begin(), array_parameters.end(),
+                para_name_to_retrieve) == array_parameters.end()) {
+    WARN("REQUESTED FIELD not present : " << para_name_to_retrieve);
+    return picojson::array();
   }
-  WARN("REQUESTED BLOCK " << block_name << " is not present ");
-  return picojson::array();
+  return block_obj->at(para_name_to_retrieve).get<picojson::array>();
 }
@@ -42,7 +42,11 @@ bool calling_resp_function(const std::string block_name,
                            int Combination_CO_size, int max_thread_position,
                            int fast_math_present);
 
-picojson::array getblock_fromconfig();
+std::string get_rtc_source_dir();
+
+const picojson::array& getblock_fromconfig();
+
+const picojson::object* get_config_block(const std::string& block_name);
 
 std::string get_string_parameters(std::string para_name_to_retrieve,
                                   std::string block_name);
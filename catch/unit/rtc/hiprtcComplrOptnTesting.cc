@@ -26,6 +26,14 @@ THE SOFTWARE.
 #include <iostream>
 #include <fstream>
 #include <hip_test_common.hh>
+#include <hip_test_parallel.hh>
+#include <hip_test_process.hh>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <numeric>
 #include "headers/RtcUtility.h"
 #include "headers/RtcFunctions.h"
 #include "headers/RtcKernels.h"
@@ -216,13 +224,35 @@ TEST_CASE("Unit_hiprtcDisabledTrappingMathComplrOptnTst") {
 Unit_hiprtcCombiComplrOptnTst is a test scenario which validates
 a combination of HIPRTC supported compiler options which a retrieved from
 RtcConfig.jason file.
+
+The checks capture stdout and stderr of the process to inspect the compiler
+output, so the combinations can not run on threads of one process. Every
+combination runs in a child process instead, which runs the hidden
+Unit_hiprtcCombiComplrOptnTst_Worker test case for it. At most
+HIP_RTC_MATRIX_THREADS children (default: the number of hardware threads) run
+at the same time. The failures are reported in the order of the combinations,
+followed by the time spent on every combination.
 */
 
+static std::string get_combi_section_name(size_t index) {
+  return "Combination_" + std::to_string(index);
+}
+
+TEST_CASE("Unit_hiprtcCombiComplrOptnTst_Worker", "[.]") {
+  std::vector<std::string> CombiCompOptions = get_combi_string_vec();
+  for (size_t i = 0; i < CombiCompOptions.size(); i++) {
+    DYNAMIC_SECTION(get_combi_section_name(i)) {
+      INFO("Combination : " << CombiCompOptions[i]);
+      REQUIRE(split_comb_string(CombiCompOptions[i]) == 0);
+    }
+  }
+}
+
 TEST_CASE("Unit_hiprtcCombiComplrOptnTst") {
   // COMBINATION COMPILER OPTIONS
   std::vector<std::string> CombiCompOptions = get_combi_string_vec();
-  int TotalCombos = CombiCompOptions.size();
-  REQUIRE(TotalCombos != -1);
+  const size_t TotalCombos = CombiCompOptions.size();
+  REQUIRE(TotalCombos != 0);
   /*
   use '-Werror=conversion' and '-Wconversion' compiler option individually as
   the generate ERROR and WARNING message which might effect when used in
@@ -232,11 +262,76 @@ TEST_CASE("Unit_hiprtcCombiComplrOptnTst") {
   '-fgpu-rdc' has to be tested in ISOLATION, cannot be validated with
   combi compiler options.
   */
+  // Every child process compiles on its own, so the default stays well below
+  // the number of hardware threads of large machines
+  constexpr size_t kDefaultMaxThreads = 8;
+  const std::string threads_env =
+      TestContext::getEnvVar("HIP_RTC_MATRIX_THREADS");
+  size_t max_threads = 0;
+  if (!threads_env.empty()) {
+    const auto end = threads_env.data() + threads_env.size();
+    const auto result = std::from_chars(threads_env.data(), end, max_threads);
+    if (result.ec != std::errc() || result.ptr != end) {
+      WARN("Invalid HIP_RTC_MATRIX_THREADS " << threads_env
+           << ", using the default");
+      max_threads = 0;
+    }
+  }
+  if (max_threads == 0) {
+    max_threads = std::min<size_t>(GetParallelThreads(TotalCombos, 0),
+                                   kDefaultMaxThreads);
+  }
+  const size_t threads = GetParallelThreads(TotalCombos, max_threads);
+
+  // The processes are set up here, the Catch macros can not be used on the
+  // threads running them
+  const std::string& exe = TestContext::get().getExeFile();
+  std::vector<std::unique_ptr<hip::SpawnProc>> procs;
+  for (size_t i = 0; i < TotalCombos; i++) {
+    procs.push_back(std::make_unique<hip::SpawnProc>(exe, true));
+  }
+
+  // Catch only prints "All tests passed" if assertions passed, not for a
+  // crashed child or a child whose section did not run
+  std::vector<char> passed(TotalCombos);
+  std::vector<double> times(TotalCombos);
+  const auto start = std::chrono::steady_clock::now();
+  ParallelFor(TotalCombos, threads, [&](size_t i) {
+    const auto combi_start = std::chrono::steady_clock::now();
+    const int status = procs[i]->run(
+        "Unit_hiprtcCombiComplrOptnTst_Worker -c " + get_combi_section_name(i));
+    passed[i] = status == 0 &&
+        procs[i]->getOutput().find("All tests passed") != std::string::npos;
+    times[i] = std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - combi_start).count();
+  });
+  const double total = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start).count();
+
   int TotalErrors = 0;
-  for (int i = 0; i < TotalCombos; i++) {
-    std::string one_combi = CombiCompOptions[i];
-    TotalErrors += split_comb_string(one_combi);
+  for (size_t i = 0; i < TotalCombos; i++) {
+    if (!passed[i]) {
+      UNSCOPED_INFO("FAILED COMBINATION " << i << " : " << CombiCompOptions[i]
+                    << "\n" << procs[i]->getOutput());
+      TotalErrors++;
+    }
   }
+
+  std::vector<size_t> order(TotalCombos);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&times](size_t a, size_t b) { return times[a] > times[b]; });
+  std::cout << "Compiler option combinations: " << TotalCombos << " on "
+            << threads << " processes in " << std::fixed
+            << std::setprecision(3) << total << " s, " << TotalErrors
+            << " failed" << std::endl;
+  for (size_t i : order) {
+    std::cout << std::setw(10) << times[i] << " s  "
+              << (passed[i] ? "" : "[failed] ") << CombiCompOptions[i]
+              << std::endl;
+  }
+  std::cout << std::defaultfloat;
+
   if (TotalErrors) {
     WARN("TOTAL FAILED CASES : " << TotalErrors);
   }
@@ -0,0 +1,203 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_batch.hh>
+#include <hip_test_common.hh>
+#include <hip_test_defgroups.hh>
+
+#include <csignal>
+#include <fstream>
+#include <sstream>
+
+/**
+ * @addtogroup TestFrameworkTest
+ * @{
+ */
+
+namespace {
+// Simulates a batch child process that dies while running the test case named crash
+int RunFakeBatch(const std::vector<std::string>& tests, BatchResultWriter& writer,
+                 const std::string& crash) {
+  for (const auto& test : tests) {
+    writer.Started(test);
+    if (test == crash) return 134;
+    const auto status = test.find("Skip") != std::string::npos ? BatchTestStatus::kSkipped
+                                                               : BatchTestStatus::kPassed;
+    writer.Ended({test, status, 0.25, "line\tone\nline \\two"});
+  }
+  return 0;
+}
+
+BatchLaunch LaunchFakeBatch(const std::vector<std::string>& tests, const std::string& crash) {
+  std::stringstream records;
+  BatchResultWriter writer([&records](const std::string& record) { records << record; });
+  BatchLaunch launch;
+  launch.status = RunFakeBatch(tests, writer, crash);
+  launch.records = ParseBatchResults(records);
+  return launch;
+}
+}  // namespace
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Writes the records of a batch child process, including messages with escaped characters,
+ *    and checks that a test case which started but never ended is read back as crashed.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testBatchRunner.cc
+ */
+TEST_CASE("Unit_BatchRunner_Records") {
+  const std::string path = "batch_runner_records.txt";
+  std::remove(path.c_str());
+  {
+    BatchResultWriter writer(path);
+    REQUIRE(RunFakeBatch({"Unit_A", "Unit_Skip", "Unit_B", "Unit_C"}, writer, "Unit_B") == 134);
+  }
+
+  const auto results = ReadBatchResults(path);
+  std::remove(path.c_str());
+  REQUIRE(results.size() == 3);
+  REQUIRE(results[0].name == "Unit_A");
+  REQUIRE(results[0].status == BatchTestStatus::kPassed);
+  REQUIRE(results[0].time == Approx(0.25));
+  REQUIRE(results[0].message == "line\tone\nline \\two");
+  REQUIRE(results[1].status == BatchTestStatus::kSkipped);
+  REQUIRE(results[2].name == "Unit_B");
+  REQUIRE(results[2].status == BatchTestStatus::kCrashed);
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Runs a batch whose first process crashes in the middle and checks that the remaining test
+ *    cases are run by a second process, and that a process which runs nothing is not relaunched.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testBatchRunner.cc
+ */
+TEST_CASE("Unit_BatchRunner_CrashFallback") {
+  const std::vector<std::string> tests = {"Unit_A", "Unit_B", "Unit_C", "Unit_Skip"};
+
+  SECTION("Fallback") {
+    std::vector<std::vector<std::string>> launched;
+    BatchRunner runner([&](const std::vector<std::string>& batch) {
+      launched.push_back(batch);
+      return LaunchFakeBatch(batch, "Unit_B");
+    });
+    const auto results = runner.Run(tests);
+    REQUIRE(runner.launches() == 2);
+    REQUIRE(launched[1] == std::vector<std::string>{"Unit_C", "Unit_Skip"});
+    REQUIRE(results.size() == tests.size());
+    REQUIRE(results[0].status == BatchTestStatus::kPassed);
+    REQUIRE(results[1].status == BatchTestStatus::kCrashed);
+    REQUIRE(results[1].message.find("exit status 134") != std::string::npos);
+    REQUIRE(results[2].status == BatchTestStatus::kPassed);
+    REQUIRE(results[3].status == BatchTestStatus::kSkipped);
+  }
+
+  SECTION("Groups") {
+    BatchRunner runner([](const std::vector<std::string>& batch) {
+      REQUIRE(batch.size() <= 3);
+      return LaunchFakeBatch(batch, "");
+    }, 3);
+    const auto results = runner.Run(tests);
+    REQUIRE(runner.launches() == 2);
+    REQUIRE(results[3].status == BatchTestStatus::kSkipped);
+  }
+
+  SECTION("NoProgress") {
+    BatchRunner runner([](const std::vector<std::string>&) { return BatchLaunch{1, {}}; });
+    const auto results = runner.Run(tests);
+    REQUIRE(runner.launches() == 1);
+    for (const auto& result : results) REQUIRE(result.status == BatchTestStatus::kNotRun);
+  }
+}
+
+#if !defined(_WIN32)
+/**
+ * Test Description
+ * ------------------------
+ *  - Runs test cases in forked children that stream their records over a pipe. One child is
+ *    killed by a signal, checks that the remaining test cases of its group run in a new child.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testBatchRunner.cc
+ */
+TEST_CASE("Unit_BatchRunner_Fork") {
+  const std::vector<std::string> tests = {"Unit_A", "Unit_B", "Unit_C", "Unit_D"};
+  BatchRunner runner([](const std::vector<std::string>& group) {
+    return ForkAndRun(group, [](const std::vector<std::string>& tests,
+                                std::unique_ptr<BatchResultWriter> writer) {
+      for (const auto& test : tests) {
+        writer->Started(test);
+        if (test == "Unit_B") std::raise(SIGKILL);
+        writer->Ended({test, BatchTestStatus::kPassed, 0, ""});
+      }
+      return 0;
+    });
+  }, 3);
+  const auto results = runner.Run(tests);
+  REQUIRE(runner.launches() == 3);
+  REQUIRE(results[0].status == BatchTestStatus::kPassed);
+  REQUIRE(results[1].status == BatchTestStatus::kCrashed);
+  REQUIRE(results[1].message.find("exit status 137") != std::string::npos);
+  REQUIRE(results[2].status == BatchTestStatus::kPassed);
+  REQUIRE(results[3].status == BatchTestStatus::kPassed);
+}
+#endif
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Writes a JUnit report and checks the counts of the suite and the escaping of the names.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testBatchRunner.cc
+ */
+TEST_CASE("Unit_BatchRunner_JUnit") {
+  const std::string path = "batch_runner_junit.xml";
+  const std::vector<BatchTestResult> results = {
+      {"Unit_<A>", BatchTestStatus::kPassed, 1, ""},
+      {"Unit_B", BatchTestStatus::kFailed, 2, "file.cc:10: \"a == b\""},
+      {"Unit_C", BatchTestStatus::kSkipped, 0, "Disabled in the config file"},
+      {"Unit_D", BatchTestStatus::kCrashed, 0.5, "The test process exited"}};
+  REQUIRE(WriteJUnitReport(path, "TestFramework", results));
+
+  std::ifstream in(path);
+  std::stringstream report;
+  report << in.rdbuf();
+  in.close();
+  std::remove(path.c_str());
+
+  const auto xml = report.str();
+  REQUIRE(xml.find("tests=\"4\" failures=\"1\" errors=\"1\" skipped=\"1\" time=\"3.500\"") !=
+          std::string::npos);
+  REQUIRE(xml.find("name=\"Unit_&lt;A&gt;\" time=\"1.000\"/>") != std::string::npos);
+  REQUIRE(xml.find("<failure message=\"file.cc:10: &quot;a == b&quot;\"/>") != std::string::npos);
+  REQUIRE(xml.find("<error type=\"crashed\"") != std::string::npos);
+}
+
+/**
+ * End doxygen group TestFrameworkTest.
+ * @}
+ */
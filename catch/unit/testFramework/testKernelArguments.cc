@@ -0,0 +1,84 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <hip_test_defgroups.hh>
+#include <hip_test_kernel_arguments.hh>
+
+#include <cstdint>
+#include <cstring>
+
+using HipTest::KernelArgumentLayout;
+using HipTest::PackedKernelArguments;
+
+static_assert(KernelArgumentLayout<>::size == 0);
+static_assert(KernelArgumentLayout<char, int>::offsets[1] == 4);
+static_assert(KernelArgumentLayout<char, int>::size == 8);
+static_assert(KernelArgumentLayout<int, char>::size == 5);
+static_assert(KernelArgumentLayout<char, double, char>::offsets[2] == 16);
+static_assert(KernelArgumentLayout<char, double, char>::alignment == alignof(double));
+
+/**
+ * @addtogroup TestFrameworkTest
+ * @{
+ */
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Packs kernel arguments of mixed sizes and alignments and checks the bytes at the offsets
+ *    expected by hipModuleLaunchKernel.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testKernelArguments.cc
+ */
+TEST_CASE("Unit_KernelArguments_Pack") {
+  struct alignas(16) Vector {
+    float x, y, z, w;
+  };
+  const char c = 'a';
+  int* const pointer = reinterpret_cast<int*>(0x1234);
+  const Vector vector{1, 2, 3, 4};
+  int16_t s = 7;
+
+  PackedKernelArguments<const char&, int* const&, const Vector&, int16_t&> arguments{c, pointer,
+                                                                                    vector, s};
+  const char* data = static_cast<const char*>(arguments.data());
+  REQUIRE(*arguments.size() == 16 + sizeof(Vector) + sizeof(int16_t));
+  REQUIRE(reinterpret_cast<uintptr_t>(data) % alignof(Vector) == 0);
+
+  REQUIRE(data[0] == c);
+  int* packedPointer;
+  std::memcpy(&packedPointer, data + sizeof(int*), sizeof(int*));
+  REQUIRE(packedPointer == pointer);
+  Vector packedVector;
+  std::memcpy(&packedVector, data + 16, sizeof(Vector));
+  REQUIRE(packedVector.z == 3);
+  int16_t packedShort;
+  std::memcpy(&packedShort, data + 16 + sizeof(Vector), sizeof(int16_t));
+  REQUIRE(packedShort == s);
+}
+
+/**
+ * End doxygen group TestFrameworkTest.
+ * @}
+ */
@@ -0,0 +1,168 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <hip_test_defgroups.hh>
+#include <hip_test_logger.hh>
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @addtogroup TestFrameworkTest
+ * @{
+ */
+
+static std::vector<std::string> ReadLines(const std::string& path) {
+  std::vector<std::string> lines;
+  std::ifstream in(path);
+  std::string line;
+  while (std::getline(in, line)) lines.push_back(line);
+  return lines;
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Logs from several threads with the drain thread running, checks the level filter and that
+ *    every message is written once with its level.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testLogger.cc
+ */
+TEST_CASE("Unit_Logger_Threads") {
+  constexpr int kThreads = 4;
+  constexpr int kMessages = 100;
+  const std::string path = "logger_threads.log";
+  std::remove(path.c_str());
+  {
+    Logger logger(LogLevel::kInfo, path);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+      threads.emplace_back([&logger, i]() {
+        for (int j = 0; j < kMessages; ++j) {
+          logger.log(LogLevel::kDebug, "filtered %d %d", i, j);
+          logger.log(LogLevel::kInfo, "thread %d message %d", i, j);
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+    logger.log(LogLevel::kError, "last");
+  }
+
+  const auto lines = ReadLines(path);
+  std::remove(path.c_str());
+  REQUIRE(lines.size() == kThreads * kMessages + 1);
+  for (size_t i = 0; i + 1 < lines.size(); ++i) {
+    REQUIRE(lines[i].find("[INFO] thread ") != std::string::npos);
+  }
+  REQUIRE(lines.back().find("[ERROR] last") != std::string::npos);
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Overflows the ring of a thread without a drain thread and checks that the messages that did
+ *    not fit are dropped, counted and reported, and that long messages continue on the following
+ *    lines.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testLogger.cc
+ */
+TEST_CASE("Unit_Logger_Overflow") {
+  const std::string path = "logger_overflow.log";
+  std::remove(path.c_str());
+  Logger logger(LogLevel::kDebug, path, false);
+  for (size_t i = 0; i < kLogRingSize + 10; ++i) logger.log(LogLevel::kDebug, "message %zu", i);
+  logger.flush();
+  const std::string long_message = "begin" + std::string(2 * kLogMessageSize, 'x') + "end";
+  logger.log(LogLevel::kWarning, "%s", long_message.c_str());
+  logger.flush();
+
+  const auto lines = ReadLines(path);
+  std::remove(path.c_str());
+  REQUIRE(lines.size() == kLogRingSize + 4);
+  REQUIRE(lines[0].find("[DEBUG] message 0") != std::string::npos);
+  REQUIRE(lines[kLogRingSize].find("10 log messages dropped") != std::string::npos);
+  std::string continued;
+  for (size_t i = kLogRingSize + 1; i < lines.size(); ++i) {
+    const auto begin = lines[i].find("[WARNING] ");
+    REQUIRE(begin != std::string::npos);
+    continued += lines[i].substr(begin + 10);
+  }
+  REQUIRE(continued == long_message);
+}
+
+#if !defined(_WIN32)
+/**
+ * Test Description
+ * ------------------------
+ *  - Logs from two threads in a forked child that aborts or calls std::terminate right away and
+ *    checks that the crash handlers flushed the messages in time order before the child died.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testLogger.cc
+ */
+TEST_CASE("Unit_Logger_CrashFlush") {
+  const bool terminate = GENERATE(false, true);
+  const std::string path = "logger_crash.log";
+  std::remove(path.c_str());
+
+  const pid_t pid = fork();
+  REQUIRE(pid >= 0);
+  if (pid == 0) {
+    Logger& logger = Logger::get();
+    logger.setOutput(path);
+    logger.setLevel(LogLevel::kInfo);
+    InstallLoggerCrashHandlers();
+    std::thread([&logger]() { logger.log(LogLevel::kInfo, "from a thread"); }).join();
+    logger.log(LogLevel::kInfo, "before the crash");
+    if (terminate) std::terminate();
+    std::abort();
+  }
+  int status = 0;
+  REQUIRE(waitpid(pid, &status, 0) == pid);
+  REQUIRE(WIFSIGNALED(status));
+  REQUIRE(WTERMSIG(status) == SIGABRT);
+
+  const auto lines = ReadLines(path);
+  std::remove(path.c_str());
+  REQUIRE(lines.size() == 2);
+  REQUIRE(lines[0].find("[INFO] from a thread") != std::string::npos);
+  REQUIRE(lines[1].find("[INFO] before the crash") != std::string::npos);
+}
+#endif
+
+/**
+ * End doxygen group TestFrameworkTest.
+ * @}
+ */
@@ -0,0 +1,107 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <hip_test_defgroups.hh>
+#include <hip_test_name_matcher.hh>
+
+/**
+ * @addtogroup TestFrameworkTest
+ * @{
+ */
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Compiles exact and wildcard patterns into a single matcher and checks that names are only
+ *    matched as a whole, with '*' matching any sequence including the empty one.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testNameMatcher.cc
+ */
+TEST_CASE("Unit_TestNameMatcher_Basic") {
+  TestNameMatcher matcher;
+  REQUIRE(matcher.empty());
+  REQUIRE_FALSE(matcher.Matches(""));
+  REQUIRE_FALSE(matcher.Matches("Unit_hipMalloc_Basic"));
+
+  matcher.Add("Unit_hipMalloc_Basic");
+  matcher.Add("Unit_hipMalloc_Basic");
+  matcher.Add("Unit_hipMemcpy*");
+  matcher.Add("*_Negative_*Parameters");
+  matcher.Add("Unit_hipStream**Capture");
+  matcher.Add("=== Disabled tests tracked with SWDEV-1234.. ===");
+  REQUIRE(matcher.size() == 5);
+
+  SECTION("Exact names") {
+    REQUIRE(matcher.Matches("Unit_hipMalloc_Basic"));
+    REQUIRE_FALSE(matcher.Matches("Unit_hipMalloc_Basi"));
+    REQUIRE_FALSE(matcher.Matches("Unit_hipMalloc_Basic_2"));
+    REQUIRE_FALSE(matcher.Matches("unit_hipMalloc_Basic"));
+  }
+
+  SECTION("Wildcards") {
+    REQUIRE(matcher.Matches("Unit_hipMemcpy"));
+    REQUIRE(matcher.Matches("Unit_hipMemcpyAsync_Positive"));
+    REQUIRE(matcher.Matches("Unit_hipFree_Negative_Parameters"));
+    REQUIRE(matcher.Matches("Unit_hipFree_Negative_Invalid_Parameters"));
+    REQUIRE(matcher.Matches("Unit_hipStreamCapture"));
+    REQUIRE(matcher.Matches("Unit_hipStreamBeginCapture"));
+    REQUIRE_FALSE(matcher.Matches("Unit_hipMemset"));
+    REQUIRE_FALSE(matcher.Matches("Unit_hipFree_Negative_Parameters_2"));
+    REQUIRE_FALSE(matcher.Matches("Unit_hipStreamCapture_Basic"));
+  }
+
+  SECTION("Characters other than the wildcard are literal") {
+    REQUIRE(matcher.Matches("=== Disabled tests tracked with SWDEV-1234.. ==="));
+    REQUIRE_FALSE(matcher.Matches("=== Disabled tests tracked with SWDEV-1234ab ==="));
+  }
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Checks that a pattern consisting only of wildcards matches every name and that patterns
+ *    sharing a prefix with exact names do not shadow each other.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testNameMatcher.cc
+ */
+TEST_CASE("Unit_TestNameMatcher_SharedPrefix") {
+  TestNameMatcher matcher;
+  matcher.Add("Unit_hipGraph*_Negative");
+  matcher.Add("Unit_hipGraphAddNode");
+  REQUIRE(matcher.Matches("Unit_hipGraphAddNode"));
+  REQUIRE(matcher.Matches("Unit_hipGraphAddNode_Negative"));
+  REQUIRE(matcher.Matches("Unit_hipGraph_Negative"));
+  REQUIRE(matcher.Matches("Unit_hipGraph_Negative_Negative"));
+  REQUIRE_FALSE(matcher.Matches("Unit_hipGraphAddNode_Positive"));
+
+  matcher.Add("**");
+  REQUIRE(matcher.Matches(""));
+  REQUIRE(matcher.Matches("Anything at all"));
+}
+
+/**
+ * End doxygen group TestFrameworkTest.
+ * @}
+ */
@@ -0,0 +1,83 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <hip_test_defgroups.hh>
+#include <hip_test_parallel.hh>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+/**
+ * @addtogroup TestFrameworkTest
+ * @{
+ */
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Runs work items on a bounded pool and checks that every item runs exactly once and that no
+ *    more threads than requested run at the same time.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testParallel.cc
+ */
+TEST_CASE("Unit_ParallelFor_Basic") {
+  const size_t threads = GENERATE(0, 1, 3, 64);
+  constexpr size_t kCount = 200;
+
+  std::vector<std::atomic<int>> runs(kCount);
+  std::atomic<size_t> running{0};
+  std::atomic<size_t> peak{0};
+  std::mutex mutex;
+  std::set<std::thread::id> ids;
+  ParallelFor(kCount, threads, [&](size_t i) {
+    const size_t now = ++running;
+    size_t previous = peak.load();
+    while (now > previous && !peak.compare_exchange_weak(previous, now)) {
+    }
+    runs[i]++;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ids.insert(std::this_thread::get_id());
+    }
+    --running;
+  });
+
+  for (const auto& count : runs) REQUIRE(count == 1);
+  REQUIRE(peak <= GetParallelThreads(kCount, threads));
+  REQUIRE(ids.size() <= GetParallelThreads(kCount, threads));
+  REQUIRE(GetParallelThreads(2, 64) == 2);
+  REQUIRE(GetParallelThreads(0, 4) == 1);
+
+  size_t calls = 0;
+  ParallelFor(0, threads, [&calls](size_t) { ++calls; });
+  REQUIRE(calls == 0);
+}
+
+/**
+ * End doxygen group TestFrameworkTest.
+ * @}
+ */
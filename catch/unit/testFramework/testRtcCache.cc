@@ -0,0 +1,236 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <hip_test_defgroups.hh>
+#include <hip_test_filesystem.hh>
+#include <hip_test_rtc_cache.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @addtogroup TestFrameworkTest
+ * @{
+ */
+
+static RtcCacheKey GetTestKey() {
+  RtcCacheKey key;
+  key.source = "__global__ void kernel() {}";
+  key.expression = "kernel";
+  key.options = {"--gpu-architecture=gfx90a"};
+  key.architectures = {"gfx90a"};
+  key.compiler = "1";
+  return key;
+}
+
+static RtcCacheEntry GetTestEntry(size_t size, char fill = 'c') {
+  return {std::vector<char>(size, fill), "_Z6kernelv"};
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Checks that every part of the key changes the digest and that fields can not be shifted
+ *    into each other. A source hash is digested instead of the source.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testRtcCache.cc
+ */
+TEST_CASE("Unit_RtcCache_Digest") {
+  const RtcCacheKey key = GetTestKey();
+  const std::string digest = GetRtcCacheDigest(key);
+  REQUIRE(digest.size() == 32);
+  REQUIRE(digest == GetRtcCacheDigest(GetTestKey()));
+
+  auto changed = key;
+  changed.source += ' ';
+  REQUIRE(GetRtcCacheDigest(changed) != digest);
+  changed = key;
+  changed.expression = "kernel2";
+  REQUIRE(GetRtcCacheDigest(changed) != digest);
+  changed = key;
+  changed.options.push_back("-O0");
+  REQUIRE(GetRtcCacheDigest(changed) != digest);
+  changed = key;
+  changed.architectures = {"gfx90a", "gfx1100"};
+  REQUIRE(GetRtcCacheDigest(changed) != digest);
+  changed = key;
+  changed.compiler = "2";
+  REQUIRE(GetRtcCacheDigest(changed) != digest);
+
+  // The content hash of an embedded source replaces the source
+  changed = key;
+  changed.source_hash = "e46ecc85ecf72e145f145d887c6a19e76f1c9b2e";
+  const std::string hashed = GetRtcCacheDigest(changed);
+  REQUIRE(hashed != digest);
+  changed.source += ' ';
+  REQUIRE(GetRtcCacheDigest(changed) == hashed);
+  changed.source_hash[0] = '0';
+  REQUIRE(GetRtcCacheDigest(changed) != hashed);
+
+  RtcCacheKey first, second;
+  first.options = {"-a", "b"};
+  second.options = {"-a b"};
+  REQUIRE(GetRtcCacheDigest(first) != GetRtcCacheDigest(second));
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Stores and loads entries, checks that missing, truncated and foreign files are misses and
+ *    that concurrent stores of the same entry leave a complete entry.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testRtcCache.cc
+ */
+TEST_CASE("Unit_RtcCache_StoreLoad") {
+  const fs::path dir = "rtc_cache_store";
+  fs::remove_all(dir);
+  RtcCodeObjectCache cache(dir.string());
+  const std::string digest = GetRtcCacheDigest(GetTestKey());
+
+  RtcCacheEntry entry;
+  REQUIRE_FALSE(cache.load(digest, entry));
+  REQUIRE(cache.store(digest, GetTestEntry(100)));
+  REQUIRE(cache.load(digest, entry));
+  REQUIRE(entry.code == GetTestEntry(100).code);
+  REQUIRE(entry.lowered_name == "_Z6kernelv");
+
+  SECTION("Invalid") {
+    std::ofstream(cache.getPath(digest).string(), std::ios::binary) << "HTRTC1\n";
+    REQUIRE_FALSE(cache.load(digest, entry));
+    std::ofstream(cache.getPath(digest).string(), std::ios::binary) << "other\nname\ncode";
+    REQUIRE_FALSE(cache.load(digest, entry));
+  }
+
+  SECTION("Concurrent") {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+      threads.emplace_back([&cache, &digest, i]() {
+        for (int j = 0; j < 20; ++j) cache.store(digest, GetTestEntry(4096, 'a' + i));
+      });
+    }
+    RtcCacheEntry loaded;
+    bool complete = true;
+    for (int j = 0; j < 100; ++j) {
+      // Either the previous or one of the new entries, never a mix
+      if (cache.load(digest, loaded)) {
+        complete = complete && (loaded.code.size() == 100 || loaded.code.size() == 4096) &&
+            std::count(loaded.code.begin(), loaded.code.end(), loaded.code[0]) ==
+                static_cast<ptrdiff_t>(loaded.code.size());
+      }
+    }
+    for (auto& thread : threads) thread.join();
+    REQUIRE(complete);
+    REQUIRE(cache.load(digest, loaded));
+    REQUIRE(loaded.code.size() == 4096);
+    size_t files = std::distance(fs::directory_iterator(dir), fs::directory_iterator());
+    REQUIRE(files == 1);
+  }
+
+  SECTION("Disabled") {
+    RtcCodeObjectCache disabled(dir.string(), 0);
+    REQUIRE_FALSE(disabled.enabled());
+    REQUIRE_FALSE(disabled.load(digest, entry));
+    REQUIRE_FALSE(disabled.store(digest, GetTestEntry(100)));
+  }
+  fs::remove_all(dir);
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Fills the cache beyond its size limit and checks that the least recently used entries are
+ *    evicted while recently loaded ones are kept.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testRtcCache.cc
+ */
+TEST_CASE("Unit_RtcCache_Eviction") {
+  const fs::path dir = "rtc_cache_eviction";
+  fs::remove_all(dir);
+  RtcCodeObjectCache cache(dir.string(), 3500);
+  std::vector<std::string> digests;
+  for (int i = 0; i < 3; ++i) {
+    auto key = GetTestKey();
+    key.expression = "kernel" + std::to_string(i);
+    digests.push_back(GetRtcCacheDigest(key));
+    REQUIRE(cache.store(digests.back(), GetTestEntry(1000)));
+    // Distinct modification times, some file systems only store seconds
+    fs::last_write_time(cache.getPath(digests.back()),
+                        fs::file_time_type::clock::now() - std::chrono::minutes(10 - i));
+  }
+  REQUIRE(cache.size() <= 3500);
+
+  RtcCacheEntry entry;
+  REQUIRE(cache.load(digests[0], entry));  // Now the most recently used
+  auto key = GetTestKey();
+  key.expression = "kernel3";
+  REQUIRE(cache.store(GetRtcCacheDigest(key), GetTestEntry(1000)));
+
+  REQUIRE(cache.size() <= 3500);
+  REQUIRE(cache.load(digests[0], entry));
+  REQUIRE_FALSE(cache.load(digests[1], entry));
+  REQUIRE(cache.load(digests[2], entry));
+  REQUIRE(cache.load(GetRtcCacheDigest(key), entry));
+  fs::remove_all(dir);
+}
+
+#if !defined(_WIN32)
+/**
+ * Test Description
+ * ------------------------
+ *  - Checks that a new cache directory is only accessible by the current user and that a
+ *    directory other users can write to disables the cache.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testRtcCache.cc
+ */
+TEST_CASE("Unit_RtcCache_Ownership") {
+  const fs::path dir = "rtc_cache_ownership";
+  fs::remove_all(dir);
+  const std::string digest = GetRtcCacheDigest(GetTestKey());
+  {
+    RtcCodeObjectCache cache(dir.string());
+    REQUIRE(cache.enabled());
+    REQUIRE_FALSE(cache.rejected());
+    REQUIRE((fs::status(dir).permissions() & fs::perms::all) == fs::perms::owner_all);
+  }
+
+  fs::permissions(dir, fs::perms::all);
+  RtcCodeObjectCache cache(dir.string());
+  REQUIRE(cache.rejected());
+  REQUIRE_FALSE(cache.enabled());
+  REQUIRE_FALSE(cache.store(digest, GetTestEntry(100)));
+  REQUIRE(fs::is_empty(dir));
+  fs::remove_all(dir);
+}
+#endif
+
+/**
+ * End doxygen group TestFrameworkTest.
+ * @}
+ */
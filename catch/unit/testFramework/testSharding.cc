@@ -0,0 +1,181 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <hip_test_defgroups.hh>
+#include <hip_test_timings.hh>
+
+#include <numeric>
+#include <sstream>
+
+/**
+ * @addtogroup TestFrameworkTest
+ * @{
+ */
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Partitions test cases with known durations and checks the longest processing time first
+ *    assignment, that every test case is assigned exactly once and that the order is kept.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testSharding.cc
+ */
+TEST_CASE("Unit_Sharding_Partition") {
+  const std::vector<std::string> tests = {"a", "b", "c", "d", "e", "f", "g"};
+  const std::vector<double> durations = {60, 10, 30, 25, 20, 5, 50};
+
+  // 60 -> 0, 50 -> 1, 30 -> 2, 25 -> 2, 20 -> 1, 10 -> 2, 5 -> 0
+  const auto shards = PartitionTests(tests, durations, 3);
+  REQUIRE(shards.size() == 3);
+  REQUIRE(shards[0] == std::vector<std::string>{"a", "f"});
+  REQUIRE(shards[1] == std::vector<std::string>{"e", "g"});
+  REQUIRE(shards[2] == std::vector<std::string>{"b", "c", "d"});
+
+  SECTION("Balance") {
+    std::vector<std::string> many;
+    std::vector<double> many_durations;
+    for (int i = 0; i < 200; ++i) {
+      many.push_back("test_" + std::to_string(i));
+      many_durations.push_back(1 + (i * 37) % 101);
+    }
+    const double total = std::accumulate(many_durations.begin(), many_durations.end(), 0.0);
+    const auto balanced = PartitionTests(many, many_durations, 8);
+    size_t assigned = 0;
+    for (const auto& shard : balanced) {
+      double load = 0;
+      for (const auto& test : shard) load += many_durations[std::stoi(test.substr(5))];
+      // LPT keeps every shard within the longest duration of the average
+      REQUIRE(std::abs(load - total / 8) <= 101);
+      assigned += shard.size();
+    }
+    REQUIRE(assigned == many.size());
+  }
+
+  SECTION("MoreShardsThanTests") {
+    const auto sparse = PartitionTests({"a", "b"}, {1, 2}, 4);
+    REQUIRE(sparse[0] == std::vector<std::string>{"b"});
+    REQUIRE(sparse[1] == std::vector<std::string>{"a"});
+    REQUIRE(sparse[2].empty());
+    REQUIRE(sparse[3].empty());
+  }
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Appends timings to a timings file, checks that the latest timing of a test case wins and
+ *    that test cases without a timing are estimated with the median of the known ones.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testSharding.cc
+ */
+TEST_CASE("Unit_Sharding_Timings") {
+  const std::string path = "sharding_timings.tsv";
+  std::remove(path.c_str());
+  REQUIRE(AppendTestTiming(path, "Unit_A", TestTiming{4, 0, "passed"}));
+  REQUIRE(AppendTestTiming(path, "Unit_B\twith tab", TestTiming{2, 0, "passed"}));
+  REQUIRE(AppendTestTiming(path, "Unit_C", TestTiming{8, 0, "passed"}));
+  REQUIRE(AppendTestTiming(path, "Unit_A", TestTiming{6, 0, "passed"}));
+
+  const auto timings = ReadTestTimings(path);
+  std::remove(path.c_str());
+  REQUIRE(timings.size() == 3);
+  REQUIRE(timings.at("Unit_A").time == 6);
+  REQUIRE(timings.at("Unit_B\twith tab").time == 2);
+
+  const auto durations = EstimateDurations({"Unit_A", "Unit_New", "Unit_C"}, timings);
+  REQUIRE(durations == std::vector<double>{6, 8, 8});
+  REQUIRE(EstimateDurations({"Unit_New"}, {}) == std::vector<double>{1});
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Checks that the shards of an executable cover every test case once and that the rotation
+ *    by executable name spreads single test case executables over the shards.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testSharding.cc
+ */
+TEST_CASE("Unit_Sharding_Rotation") {
+  const std::vector<std::string> tests = {"a", "b", "c", "d", "e"};
+  const std::vector<double> durations = {5, 4, 3, 2, 1};
+  size_t total = 0;
+  for (size_t index = 0; index < 3; ++index) {
+    total += GetShardTests(tests, durations, index, 3, "MemoryTest").size();
+  }
+  REQUIRE(total == tests.size());
+  REQUIRE(GetShardTests(tests, durations, 3, 3, "MemoryTest").empty());
+
+  std::vector<size_t> single(8, 0);
+  for (int exe = 0; exe < 64; ++exe) {
+    for (size_t index = 0; index < single.size(); ++index) {
+      single[index] +=
+          GetShardTests({"test"}, {1}, index, single.size(), "Exe" + std::to_string(exe)).size();
+    }
+  }
+  REQUIRE(std::accumulate(single.begin(), single.end(), size_t{0}) == 64);
+  REQUIRE(*std::max_element(single.begin(), single.end()) < 32);
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Records setup times and results in a timings file, reads them back and checks the report
+ *    of the slowest test cases.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testSharding.cc
+ */
+TEST_CASE("Unit_Sharding_SlowestTests") {
+  const std::string path = "sharding_slowest.tsv";
+  std::remove(path.c_str());
+  REQUIRE(AppendTestTiming(path, "Unit_A", {1.5, 0.25, "passed"}));
+  REQUIRE(AppendTestTiming(path, "Unit_B", {3, 0, "failed"}));
+  REQUIRE(AppendTestTiming(path, "Unit_C", {0.5, 0, "skipped"}));
+
+  const auto timings = ReadTestTimings(path);
+  std::remove(path.c_str());
+  REQUIRE(timings.size() == 3);
+  REQUIRE(timings.at("Unit_A").setup == 0.25);
+  REQUIRE(timings.at("Unit_A").result == "passed");
+  REQUIRE(timings.at("Unit_B").result == "failed");
+
+  std::vector<std::pair<std::string, TestTiming>> run(timings.begin(), timings.end());
+  std::stringstream report;
+  PrintSlowestTests(report, run, 2);
+  REQUIRE(report.str() ==
+          "Slowest test cases:\n"
+          "     3.000 s  Unit_B [failed]\n"
+          "     1.500 s  Unit_A (setup 0.250 s)\n");
+
+  std::stringstream empty;
+  PrintSlowestTests(empty, run, 0);
+  REQUIRE(empty.str().empty());
+}
+
+/**
+ * End doxygen group TestFrameworkTest.
+ * @}
+ */
@@ -0,0 +1,162 @@
+/*
+Copyright (c) 2023 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include <hip_test_common.hh>
+#include <hip_test_defgroups.hh>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @addtogroup TestFrameworkTest
+ * @{
+ */
+
+static void ThreadChecks(size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    HIP_CHECK_THREAD(hipSuccess);
+    REQUIRE_THREAD(i < count);
+  }
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Runs many passing HIP_CHECK_THREAD and REQUIRE_THREAD checks from several threads, then
+ *    finalizes them twice to check that the counters are cleared.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testThreadChecks.cc
+ */
+TEST_CASE("Unit_ThreadChecks_Passed") {
+  constexpr size_t kThreads = 8;
+  constexpr size_t kChecks = 100000;
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreads; ++i) threads.emplace_back(ThreadChecks, kChecks);
+  for (auto& thread : threads) thread.join();
+  REQUIRE_FALSE(TestContext::get().hasErrorOccured());
+  HIP_CHECK_THREAD_FINALIZE();
+
+  ThreadChecks(1);
+  HIP_CHECK_THREAD_FINALIZE();
+}
+
+#if !defined(_WIN32)
+// Waits for every thread before failing, so that none of them skips its check because another one
+// failed first
+static bool ArriveAndFail(std::atomic<size_t>& arrived, size_t threads) {
+  arrived.fetch_add(1);
+  while (arrived.load() < threads) std::this_thread::yield();
+  return false;
+}
+
+static size_t CountOccurrences(const std::string& text, const std::string& pattern) {
+  size_t count = 0;
+  for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+/**
+ * Test Description
+ * ------------------------
+ *  - Fails REQUIRE_THREAD on several threads that exit before HIP_CHECK_THREAD_FINALIZE, in a
+ *    forked child whose output is captured. Checks that the finalize fails and reports every
+ *    failure, and that a second finalize passes.
+ * Test source
+ * ------------------------
+ *  - unit/testFramework/testThreadChecks.cc
+ */
+TEST_CASE("Unit_ThreadChecks_Failed") {
+  constexpr size_t kThreads = 8;
+  const std::string path = "thread_checks_failed.log";
+  std::remove(path.c_str());
+
+  std::cout.flush();
+  std::fflush(nullptr);
+  const pid_t pid = fork();
+  REQUIRE(pid >= 0);
+  if (pid == 0) {
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || dup2(fd, STDOUT_FILENO) < 0) _exit(100);
+    std::atomic<size_t> arrived{0};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < kThreads; ++i) {
+      threads.emplace_back([&arrived]() {
+        HIP_CHECK_THREAD(hipSuccess);
+        REQUIRE_THREAD(ArriveAndFail(arrived, kThreads));
+      });
+    }
+    for (auto& thread : threads) thread.join();
+
+    // The failing finalize reports through Catch and throws, the child only records the outcome
+    int status = 0;
+    try {
+      HIP_CHECK_THREAD_FINALIZE();
+    } catch (...) {
+      status |= 1;
+    }
+    try {
+      HIP_CHECK_THREAD_FINALIZE();
+      status |= 2;
+    } catch (...) {
+    }
+    std::cout.flush();
+    std::fflush(nullptr);
+    _exit(status);
+  }
+
+  int status = 0;
+  REQUIRE(waitpid(pid, &status, 0) == pid);
+  REQUIRE(WIFEXITED(status));
+  REQUIRE(WEXITSTATUS(status) == 3);
+
+  std::stringstream output;
+  output << std::ifstream(path).rdbuf();
+  std::remove(path.c_str());
+  INFO(output.str());
+  REQUIRE(CountOccurrences(output.str(), "HIP API Result check") == kThreads);
+  REQUIRE(CountOccurrences(output.str(), "API:: ArriveAndFail(arrived, kThreads)") == kThreads);
+  const std::string summary =
+      std::to_string(kThreads) + " of " + std::to_string(2 * kThreads) + " threaded checks failed";
+  REQUIRE(output.str().find(summary) != std::string::npos);
+}
+#endif
+
+/**
+ * End doxygen group TestFrameworkTest.
+ * @}
+ */